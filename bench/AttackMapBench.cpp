@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Attacks.hpp"
+#include "BenchPositions.hpp"
+#include "Board.hpp"
+#include "MoveList.hpp"
+
+using namespace std;
+
+namespace {
+
+constexpr int benchDepth = 4;
+constexpr int repetitions = 5;
+
+// Every move of the tree is made and unmade, also at the last ply, so the attack map update is paid once per node.
+// The legal generator reads the maps at every inner node.
+uint64_t walkTree(Board& board, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    board.getValidMovesWithCheck(moves);
+
+    uint64_t nodes = 0;
+
+    for (Move move : moves) {
+        board.doMove(move);
+        nodes += walkTree(board, depth - 1);
+        board.undoMove(move);
+    }
+
+    return nodes;
+}
+
+struct Timing {
+    uint64_t nodes;
+    double bestSeconds;
+};
+
+Timing timeWalk(bool incremental) {
+    Timing timing { 0, 0.0 };
+
+    for (int repetition = 0; repetition <= repetitions; ++repetition) {
+        uint64_t nodes = 0;
+        auto start = chrono::steady_clock::now();
+
+        for (const string& fen : benchPositions) {
+            Board board(fen);
+            board.setIncrementalAttackMaps(incremental);
+
+            nodes += walkTree(board, benchDepth);
+        }
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // The first walk only warms the caches and the branch predictors
+        if (repetition == 0) {
+            continue;
+        }
+
+        timing.nodes = nodes;
+
+        if (repetition == 1 || seconds < timing.bestSeconds) {
+            timing.bestSeconds = seconds;
+        }
+    }
+
+    return timing;
+}
+
+}   // namespace
+
+int main() {
+    initAttackTables();
+
+    Timing full = timeWalk(false);
+    Timing incremental = timeWalk(true);
+
+    if (full.nodes != incremental.nodes) {
+        cerr << "Node counts differ: " << full.nodes << " full, " << incremental.nodes << " incremental\n";
+        return 1;
+    }
+
+    cout << fixed << setprecision(1);
+    cout << "Perft " << benchDepth << " over " << benchPositions.size() << " positions, " << full.nodes
+         << " nodes, best of " << repetitions << "\n";
+
+    for (auto [name, timing] : { pair { "full", full }, pair { "incremental", incremental } }) {
+        cout << setw(12) << name << ": " << setw(8) << timing.bestSeconds * 1e9 / static_cast<double>(timing.nodes)
+             << " ns/node, " << setw(8) << static_cast<double>(timing.nodes) / timing.bestSeconds / 1e6
+             << " Mnodes/s\n";
+    }
+
+    cout << setprecision(2) << "Speedup: " << full.bestSeconds / incremental.bestSeconds << "x\n";
+}
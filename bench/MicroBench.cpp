@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Attacks.hpp"
+#include "BenchPositions.hpp"
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "MoveList.hpp"
+
+using namespace std;
+
+namespace {
+
+constexpr int repetitions = 10;
+
+// Every timed sample runs at least this long, so the clock resolution does not show in the result
+constexpr double minimumSampleSeconds = 0.02;
+
+// Keeps the compiler from dropping a result nothing reads
+template <typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchBoard {
+    Board board;
+    MoveList moves;
+};
+
+// One sample: op runs on every board iterations times. Returns the seconds it took per operation, op returns how
+// many operations one call performed.
+template <typename Op>
+double sample(vector<BenchBoard>& boards, uint64_t iterations, Op& op) {
+    uint64_t operations = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (uint64_t iteration = 0; iteration < iterations; ++iteration) {
+        for (BenchBoard& benchBoard : boards) {
+            operations += op(benchBoard);
+        }
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    return seconds / static_cast<double>(operations);
+}
+
+template <typename Op>
+void run(const string& name, vector<BenchBoard>& boards, Op op) {
+    // The warm-up doubles the iterations until a sample is long enough, and is not measured itself
+    uint64_t iterations = 1;
+    double secondsPerOperation = sample(boards, iterations, op);
+
+    while (secondsPerOperation * static_cast<double>(iterations * boards.size()) < minimumSampleSeconds) {
+        iterations *= 2;
+        secondsPerOperation = sample(boards, iterations, op);
+    }
+
+    vector<double> nanoseconds;
+
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+        nanoseconds.push_back(sample(boards, iterations, op) * 1e9);
+    }
+
+    double mean = 0.0;
+
+    for (double value : nanoseconds) {
+        mean += value;
+    }
+
+    mean /= static_cast<double>(nanoseconds.size());
+
+    double variance = 0.0;
+
+    for (double value : nanoseconds) {
+        variance += (value - mean) * (value - mean);
+    }
+
+    variance /= static_cast<double>(nanoseconds.size() - 1);
+
+    double best = *min_element(nanoseconds.begin(), nanoseconds.end());
+
+    cout << fixed << setprecision(2) << left << setw(28) << name << right << setw(12) << mean << setw(12) << best
+         << setw(9) << sqrt(variance) / mean * 100 << "%" << setw(14) << 1e3 / mean << "\n";
+}
+
+}   // namespace
+
+int main() {
+    initAttackTables();
+
+    vector<BenchBoard> boards;
+
+    for (const string& fen : benchPositions) {
+        Board board(fen);
+        MoveList moves;
+        board.getValidMovesWithCheck(moves);
+
+        boards.push_back({ board, moves });
+    }
+
+    cout << "Slider attacks: " << sliderBackendName(activeSliderBackend()) << "\n";
+    cout << benchPositions.size() << " positions, best and mean of " << repetitions << " samples of at least "
+         << minimumSampleSeconds * 1e3 << " ms each after a warm-up\n\n";
+
+    cout << left << setw(28) << "Benchmark" << right << setw(12) << "ns/op" << setw(12) << "best ns/op" << setw(10)
+         << "stddev" << setw(14) << "Mops/s" << "\n";
+
+    run("getValidMovesWithCheck", boards, [](BenchBoard& benchBoard) {
+        MoveList moves;
+        benchBoard.board.getValidMovesWithCheck(moves);
+        doNotOptimize(moves);
+        return 1;
+    });
+
+    // One operation is a doMove and the undoMove after it
+    run("doMove + undoMove", boards, [](BenchBoard& benchBoard) {
+        for (Move move : benchBoard.moves) {
+            benchBoard.board.doMove(move);
+            benchBoard.board.undoMove(move);
+        }
+
+        return static_cast<int>(benchBoard.moves.size());
+    });
+
+    run("hash", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.hash());
+        return 1;
+    });
+
+    run("evaluation", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.evaluation());
+        return 1;
+    });
+
+    // Attack generators run for both colours, each colour counts as one operation
+    run("getPawnAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getPawnAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getPawnAttacks<Color::black>());
+        return 2;
+    });
+
+    run("getKnightAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getKnightAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getKnightAttacks<Color::black>());
+        return 2;
+    });
+
+    run("getBishopAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getBishopAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getBishopAttacks<Color::black>());
+        return 2;
+    });
+
+    run("getRookAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getRookAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getRookAttacks<Color::black>());
+        return 2;
+    });
+
+    run("getQueenAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getQueenAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getQueenAttacks<Color::black>());
+        return 2;
+    });
+
+    run("getKingAttacks", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getKingAttacks<Color::white>());
+        doNotOptimize(benchBoard.board.getKingAttacks<Color::black>());
+        return 2;
+    });
+
+    // The full attack map kernel, against the maps doMove keeps up to date
+    run("getAttackMap(occupied)", boards, [](BenchBoard& benchBoard) {
+        const Position& position = benchBoard.board.getPosition();
+        uint64_t occupied = position.colorBB[0] | position.colorBB[1];
+
+        doNotOptimize(benchBoard.board.getAttackMap<Color::white>(occupied));
+        doNotOptimize(benchBoard.board.getAttackMap<Color::black>(occupied));
+        return 2;
+    });
+
+    run("getAttackMap()", boards, [](BenchBoard& benchBoard) {
+        doNotOptimize(benchBoard.board.getAttackMap<Color::white>());
+        doNotOptimize(benchBoard.board.getAttackMap<Color::black>());
+        return 2;
+    });
+}
@@ -0,0 +1,26 @@
+#ifndef ATTACKMAP_H
+#define ATTACKMAP_H
+
+#include <cstdint>
+
+// The pieces of one side that contribute to its attack map
+struct AttackingPieces {
+    uint64_t pawns;
+    uint64_t knights;
+    uint64_t diagonalSliders;   // bishops and queens
+    uint64_t straightSliders;   // rooks and queens
+    uint64_t king;
+    bool white;
+};
+
+// Every square attacked by one side, with sliding rays stopped by occupied. Sliding attacks are computed with
+// Kogge-Stone occluded fills in all eight directions at once, so the cost does not depend on the position.
+uint64_t attackMap(const AttackingPieces& pieces, uint64_t occupied);
+
+// Both kernels behind attackMap, exposed so they can be compared directly
+uint64_t attackMapScalar(const AttackingPieces& pieces, uint64_t occupied);
+uint64_t attackMapAvx2(const AttackingPieces& pieces, uint64_t occupied);
+
+bool attackMapUsesAvx2();
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Constants.hpp"
+
+enum class SliderBackend : std::uint8_t { automatic, magic, pext };
+
+// BMI2 parallel bit extract. Emitted as inline assembly so the rest of the build does not need -mbmi2 and
+// still runs on hosts without it; it is only reached once initAttackTables has selected the pext backend.
+inline uint64_t parallelBitsExtract(uint64_t value, uint64_t mask) {
+#if defined(__x86_64__)
+    uint64_t result = 0;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(value), "rm"(mask));
+    return result;
+#else
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+        if ((value & mask & -mask) != 0) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+#endif
+}
+
+// Slider attack table entry for one square. With the magic backend the relevant occupancy bits are multiplied
+// by the magic number and the top bits of the product index into that square's slice of the attack table.
+// With the pext backend the relevant bits are extracted directly, so the table is filled in a different order.
+struct Magic {
+    uint64_t mask;
+    uint64_t magic;
+    uint64_t* attacks;
+    unsigned shift;
+    bool pext;
+
+    size_t index(uint64_t occupied) const {
+        if (pext) {
+            return static_cast<size_t>(parallelBitsExtract(occupied, mask));
+        }
+        return static_cast<size_t>(((occupied & mask) * magic) >> shift);
+    }
+};
+
+// Squares strictly between two squares that share a row, column or diagonal, empty for any other pair
+constexpr std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> generateBetweenSquares() {
+    std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> between {};
+
+    for (int from = 0; from < numBoardSquares; ++from) {
+        for (int rowStep = -1; rowStep <= 1; ++rowStep) {
+            for (int colStep = -1; colStep <= 1; ++colStep) {
+                uint64_t ray = 0;
+                int row = from / boardSize + rowStep;
+                int col = from % boardSize + colStep;
+
+                while ((rowStep != 0 || colStep != 0) && row >= 0 && row < boardSize && col >= 0 && col < boardSize) {
+                    int to = row * boardSize + col;
+                    between[static_cast<size_t>(from)][static_cast<size_t>(to)] = ray;
+                    ray |= 1ULL << to;
+
+                    row += rowStep;
+                    col += colStep;
+                }
+            }
+        }
+    }
+
+    return between;
+}
+
+inline constexpr std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> betweenSquares
+  = generateBetweenSquares();
+
+// The whole row, column or diagonal through two aligned squares, both included, empty for any other pair
+constexpr std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> generateLineSquares() {
+    std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> lines {};
+
+    for (int from = 0; from < numBoardSquares; ++from) {
+        for (int rowStep = -1; rowStep <= 1; ++rowStep) {
+            for (int colStep = -1; colStep <= 1; ++colStep) {
+                if (rowStep == 0 && colStep == 0) {
+                    continue;
+                }
+
+                // Walk back to the edge first, then collect the line in the step direction
+                int row = from / boardSize;
+                int col = from % boardSize;
+
+                while (row - rowStep >= 0 && row - rowStep < boardSize && col - colStep >= 0
+                       && col - colStep < boardSize) {
+                    row -= rowStep;
+                    col -= colStep;
+                }
+
+                uint64_t line = 0;
+                for (int r = row, c = col; r >= 0 && r < boardSize && c >= 0 && c < boardSize;
+                     r += rowStep, c += colStep) {
+                    line |= 1ULL << (r * boardSize + c);
+                }
+
+                for (int r = from / boardSize + rowStep, c = from % boardSize + colStep;
+                     r >= 0 && r < boardSize && c >= 0 && c < boardSize; r += rowStep, c += colStep) {
+                    lines[static_cast<size_t>(from)][static_cast<size_t>(r * boardSize + c)] = line;
+                }
+            }
+        }
+    }
+
+    return lines;
+}
+
+inline constexpr std::array<std::array<uint64_t, numBoardSquares>, numBoardSquares> lineSquares
+  = generateLineSquares();
+
+extern std::array<Magic, numBoardSquares> rookMagics;
+extern std::array<Magic, numBoardSquares> bishopMagics;
+
+// Fills the slider attack tables for the requested backend. Automatic picks pext when the CPU reports BMI2,
+// and a forced pext request falls back to magic on hosts without it. Must run once before any Board is used.
+void initAttackTables(SliderBackend backend = SliderBackend::automatic);
+
+SliderBackend activeSliderBackend();
+const char* sliderBackendName(SliderBackend backend);
+
+inline uint64_t rookAttacks(int square, uint64_t occupied) {
+    const Magic& magic = rookMagics[static_cast<size_t>(square)];
+    return magic.attacks[magic.index(occupied)];
+}
+
+inline uint64_t bishopAttacks(int square, uint64_t occupied) {
+    const Magic& magic = bishopMagics[static_cast<size_t>(square)];
+    return magic.attacks[magic.index(occupied)];
+}
+
+inline uint64_t queenAttacks(int square, uint64_t occupied) {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+#endif
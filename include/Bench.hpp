@@ -0,0 +1,16 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Searches the bench positions to depth with one thread, the way a game asks the engine for a move, and prints the
+// nodes of every position, the total and the nodes per second. The total is a signature of the search: a change
+// that only makes it faster leaves it unchanged.
+uint64_t runBench(int depth);
+
+// Searches the bench positions to depth with 1, 2, 4 ... maxThreads threads and prints the time to depth, nodes per
+// second, speedup, efficiency and the extra nodes searched compared to one thread, as a table and as CSV
+void runBenchScaling(int depth, size_t maxThreads);
+
+#endif
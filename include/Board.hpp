@@ -4,111 +4,286 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "BoardHashing.hpp"
 #include "Constants.hpp"
-#include "FixedSizeVector.hpp"
 #include "Move.hpp"
+#include "MoveList.hpp"
+#include "Position.hpp"
+
+// Check and pin information of a position, computed once whenever the position changes. Checkers and check
+// squares are seen from the side to move.
+struct CheckInfo {
+    // Opposing pieces giving check to the side to move
+    uint64_t checkers;
+
+    // Pieces of each colour (black, white) that are the only blocker between their own king and an opposing slider
+    std::array<uint64_t, 2> pinned;
+
+    // Pieces of the side to move that are the only blocker between one of its sliders and the opposing king, any
+    // move off that line gives check
+    uint64_t discoverers;
+
+    // Squares every piece kind of the side to move would attack the opposing king from
+    std::array<uint64_t, numPieceKinds> checkSquares;
+
+    // Opposing king
+    int kingSquare;
+};
+
+// Everything doMove overwrites that can not be recomputed from the move itself, pushed once per ply
+struct BoardState {
+    PieceTypes capturedPiece;
+    int8_t castleRights;
+    int8_t enPassantSquare;
+    uint8_t halfmoveClock;
+    uint64_t hashKey;
+    double eval;
+    CheckInfo checkInfo;
+    uint64_t whiteSlidingAttacking;
+    uint64_t whiteNonSlidingAttacking;
+    uint64_t blackNonSlidingAttacking;
+    uint64_t blackSlidingAttacking;
+};
+
+// Which moves a generator call emits. Captures and quiets together are exactly the moves of all, quiet checks are
+// the quiet moves that give check directly or by uncovering a slider. Promotions are not generated by this engine,
+// so the captures mode holds captures only.
+enum class GenType : std::uint8_t { captures, quiets, quietChecks, all };
+
+// Check and pin information for the side to move, computed once per node and shared by every generation stage
+struct LegalMasks {
+    // Pieces giving check
+    uint64_t checkers;
+
+    // Squares a non-king move has to end on, every square when not in check
+    uint64_t checkMask;
+
+    // Rays from the king up to and including the pinning piece
+    uint64_t straightPinMask;
+    uint64_t diagonalPinMask;
+
+    // Squares the king can step to without being attacked, including captures
+    uint64_t kingTargets;
+};
 
 class Board {
 private:
-    std::array<uint64_t, numTypesPieces> pieceBB {};
+    Position position {};
 
-    uint64_t whitePieces = 0;
-    uint64_t blackPieces = 0;
-
-    // Bitboards for white attacks
+    // Squares attacked by each side's sliders and by its other pieces in the current position. doMove only
+    // recomputes the maps the move can have changed and undoMove restores them from the state stack.
     uint64_t whiteSlidingAttacking = 0;
     uint64_t whiteNonSlidingAttacking = 0;
 
-    // Bitboards for black attacks
     uint64_t blackNonSlidingAttacking = 0;
     uint64_t blackSlidingAttacking = 0;
 
-    int castleRights = 0b1111;
+    // When off every move recomputes all four maps, only there to measure the incremental update against
+    bool incrementalAttackMaps = true;
 
-    bool whiteTurn = true;
+    bool gameOver = false;
 
-    double currentEval = 0;
+    // Only the moves made on this board, a board built from a Position starts with an empty stack
+    std::vector<BoardState> stateStack;
 
-    bool gameOver = false;
+    // Always describes the current position for the side to move
+    CheckInfo checkInfo {};
+
+    void updateCheckInfo();
+
+    template <Color Us>
+    uint64_t computeSlidingAttacks() const;
+    template <Color Us>
+    uint64_t computeNonSlidingAttacks() const;
+
+    void computeAttackMaps();
+
+    // Recomputes the maps of one side only when one of its pieces was moved or captured, or when changedSquares
+    // lies on the rays of its sliders
+    template <Color Us>
+    void updateAttackMaps(PieceTypes pieceType, PieceTypes capturedPiece, uint64_t changedSquares);
+
+    template <Color Us>
+    uint64_t slidingAttacks() const {
+        return Us == Color::white ? whiteSlidingAttacking : blackSlidingAttacking;
+    }
+
+    // Whether no piece of the other side can reach the target of the move, also once the mover has left its square
+    bool targetIsUncontested(Move move) const;
 
-    FixedSizeVector<Move> allPossibleMoves { 100 };
+    // Zobrist key from scratch. doMove keeps the key up to date by XORing only the keys that change, and debug
+    // builds check the result against this after every move.
+    uint64_t computeHash() const;
 
-    std::array<uint64_t, numBoardSquares>* knightMoves;
+    uint64_t pieceBB(int pieceType) const { return position.pieces(pieceType); }
+    uint64_t whitePieces() const { return position.colorBB[1]; }
+    uint64_t blackPieces() const { return position.colorBB[0]; }
 
+    template <Color Us>
+    uint64_t pieceBB(PieceKind kind) const {
+        return position.pieces<Us>(kind);
+    }
+    // Pieces of the kind for both colours
+    uint64_t kindBB(PieceKind kind) const { return position.kindBB[static_cast<size_t>(kind)]; }
 
-    BoardHashing boardHashing;
+    template <Color Us>
+    uint64_t piecesOf() const {
+        return position.colorBB[static_cast<size_t>(Us)];
+    }
 
+    void togglePiece(int pieceType, uint64_t mask) {
+        position.kindBB[static_cast<size_t>(pieceKind(pieceType))] ^= mask;
+        position.colorBB[static_cast<size_t>(pieceColor(pieceType))] ^= mask;
+    }
 
-    void getStraightMoves(uint64_t pieces, bool white);
-    void getDiagonalMoves(uint64_t pieces, bool white);
+    template <Color Us, GenType Type>
+    void getStraightMoves(uint64_t pieces, PieceKind kind, const CheckInfo& checks, MoveList& moves);
+    template <Color Us, GenType Type>
+    void getDiagonalMoves(uint64_t pieces, PieceKind kind, const CheckInfo& checks, MoveList& moves);
+
+    // Only the quiet check mode looks at the check squares, every other mode gets an empty CheckInfo
+    template <Color Us, GenType Type>
+    CheckInfo checkInfoFor() const;
+
+    template <Color Us>
+    std::pair<Move, bool> processUserInput(const std::string& userInput);
 
 
 public:
-    Board(std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing)
-        : Board(defaultBoardPosition, knightMoves, boardHashing) {}
-    Board(const std::string& fen, std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing);
+    Board()
+        : Board(defaultBoardPosition) {}
+    Board(const std::string& fen);
+    Board(const Position& position);
 
     Board(const Board& other) = default;
 
-    Board& operator=(const Board& other) {
-        if (this != &other) {
-            pieceBB = other.pieceBB;
-            whitePieces = other.whitePieces;
-            blackPieces = other.blackPieces;
-            whiteSlidingAttacking = other.whiteSlidingAttacking;
-            whiteNonSlidingAttacking = other.whiteNonSlidingAttacking;
-            blackNonSlidingAttacking = other.blackNonSlidingAttacking;
-            blackSlidingAttacking = other.blackSlidingAttacking;
-            castleRights = other.castleRights;
-            whiteTurn = other.whiteTurn;
-            allPossibleMoves = other.allPossibleMoves;
-        }
-
-        return *this;
-    }
+    Board& operator=(const Board& other) = default;
+
+
+    const Position& getPosition() const { return position; }
 
+    // Replaces the position and forgets the moves made so far
+    void setPosition(const Position& newPosition);
 
-    bool isWhiteTurn() const { return whiteTurn; }
+    bool isWhiteTurn() const { return position.whiteTurn; }
 
     bool isGameOver() const { return gameOver; }
     void setGameOver() { gameOver = true; }
 
-    uint64_t getPawnAttacks(bool white) const;
+    // Attack and move generation are templated on the side they are generated for, so masks, shift directions and
+    // piece indices are compile time constants
+    template <Color Us>
+    uint64_t getPawnAttacks() const;
+
+    template <Color Us>
+    uint64_t getKnightAttacks() const;
+
+    uint64_t getStraightAttacks(uint64_t pieces) const;
+    template <Color Us>
+    uint64_t getRookAttacks() const;
+
+    uint64_t getDiagonalAttacks(uint64_t pieces) const;
+    template <Color Us>
+    uint64_t getBishopAttacks() const;
+    template <Color Us>
+    uint64_t getQueenAttacks() const;
+    template <Color Us>
+    uint64_t getKingAttacks() const;
+
+    // Every square attacked by the given side, with sliding rays stopped by occupied, computed from scratch
+    template <Color Us>
+    uint64_t getAttackMap(uint64_t occupied) const;
+
+    // Every square attacked by the given side in the current position, read from the maps doMove keeps up to date
+    template <Color Us>
+    uint64_t getAttackMap() const {
+        return Us == Color::white ? whiteSlidingAttacking | whiteNonSlidingAttacking
+                                  : blackSlidingAttacking | blackNonSlidingAttacking;
+    }
+
+    void setIncrementalAttackMaps(bool incremental) { incrementalAttackMaps = incremental; }
+
+    // Pseudo legal moves, restricted to the targets of the generation mode before they are added
+    template <Color Us, GenType Type = GenType::all>
+    void getPawnMoves(MoveList& moves);
+    template <Color Us, GenType Type = GenType::all>
+    void getKnightMoves(MoveList& moves);
+
+    template <Color Us, GenType Type = GenType::all>
+    void getBishopMoves(MoveList& moves);
+    template <Color Us, GenType Type = GenType::all>
+    void getRookMoves(MoveList& moves);
+    template <Color Us, GenType Type = GenType::all>
+    void getQueenMoves(MoveList& moves);
+    template <Color Us, GenType Type = GenType::all>
+    void getKingMoves(MoveList& moves);
+
+    // Check info computed from scratch with Us as the side to move, also when it is not Us's turn
+    template <Color Us>
+    CheckInfo computeCheckInfo() const;
+
+    // Cached check info of the current position
+    const CheckInfo& getCheckInfo() const { return checkInfo; }
 
-    uint64_t getKnightAttacks(bool white) const;
+    bool inCheck() const { return checkInfo.checkers != 0; }
 
-    uint64_t getStraightAttacks(uint64_t pieces, bool white) const;
-    uint64_t getRookAttacks(bool white) const;
+    // Whether the move of the side to move checks the opposing king, directly or by uncovering a slider, answered
+    // from the cached check info without making the move
+    bool givesCheck(Move move) const;
 
-    uint64_t getDiagonalAttacks(uint64_t pieces, bool white) const;
-    uint64_t getBishopAttacks(bool white) const;
-    uint64_t getQueenAttacks(bool white) const;
-    uint64_t getKingAttacks(bool white) const;
+    // Makes the move and pushes the state it overwrites, undoMove pops it again. Moves have to be undone in the
+    // reverse order they were made.
+    void doMove(Move move);
+    void undoMove(Move move);
 
-    void getPawnMoves(bool white);
-    void getKnightMoves(bool white);
+    PieceTypes lastCapturedPiece() const { return stateStack.back().capturedPiece; }
 
-    void getBishopMoves(bool white);
-    void getRookMoves(bool white);
-    void getQueenMoves(bool white);
-    void getKingMoves(bool white);
+    int getCastleRights() const { return position.castleRights; }
+    int getEnPassantSquare() const { return position.enPassantSquare; }
+    int getHalfmoveClock() const { return position.halfmoveClock; }
 
-    int processMoveWithReEvaulation(const Move& move);
-    void unProcessMoveWithReEvaulation(const Move& move, int pieceTypeRemoved);
+    // Pieces of both sides that attack square, with sliding rays stopped by occupied. Works backwards from the
+    // square, so it costs a handful of table lookups instead of a scan over every piece.
+    uint64_t attackersTo(int square, uint64_t occupied) const;
 
-    int processMove(Move move);
-    void unProcessMove(Move move, int pieceTypeRemoved);
+    // Whether any piece of the given side attacks square
+    template <Color Us>
+    bool isSquareAttacked(int square, uint64_t occupied) const;
 
-    bool moveIsValidWithCheck(Move move, bool white);
+    // Static exchange evaluation. The material the mover ends up with when both sides keep recapturing on the
+    // target square with their least valuable attacker and may stop whenever continuing would lose material.
+    // Sliders behind an exchanged piece join in as it leaves, pins are ignored.
+    int see(Move move) const;
 
-    void addValidMoves(const std::vector<Move>& potentialMoves, std::vector<Move>& moves, bool white);
+    // Whether see(move) >= threshold, stopping as soon as the outcome is known
+    bool seeGE(Move move, int threshold) const;
 
-    void getValidMovesNoCheckNoKing(bool white);
+    // Whether a move taken from a cache or a heuristic could have been generated for the side to move here: the
+    // mover's piece is on the start square, the target and flags fit how that piece moves, and when in check the
+    // move at least answers the check. Pins and the king's own safety are left to isLegal.
+    bool isPseudoLegal(Move move) const;
 
-    std::vector<Move> getValidMovesWithCheck();
+    // Whether a pseudo legal move keeps the mover's king safe, using the cached pins instead of making the move
+    bool isLegal(Move move) const;
+
+    // Whether the move leaves the mover's king safe, answered without making it
+    bool moveIsValidWithCheck(Move move, bool white) const;
+
+    // Legal moves for the side to move. Every piece's targets are masked with the check mask and, for pinned
+    // pieces, the pin ray before they are added, so no move has to be made to test it.
+    template <Color Us>
+    void getValidMovesWithCheck(MoveList& moves);
+    void getValidMovesWithCheck(MoveList& moves);
+
+    // The same generator split in two, so a move picker can compute the masks once and then generate captures and
+    // quiet moves in separate stages
+    template <Color Us>
+    LegalMasks getLegalMasks() const;
+    template <Color Us, GenType Type>
+    void getLegalMoves(const LegalMasks& masks, MoveList& moves) const;
 
     double evaluation() const;
 
@@ -117,10 +292,7 @@ public:
     void displayBoard() const;
 
 
-    void resetAllPossibleMoves() { allPossibleMoves.clear(); }
-
-
-    uint64_t hash() const;
+    uint64_t hash() const { return position.hashKey; }
 };
 
 #endif
@@ -1,13 +1,62 @@
+#ifndef BOARDHASHING_H
+#define BOARDHASHING_H
+
 #include <Constants.hpp>
 #include <array>
 #include <cstdint>
 
+// Zobrist keys are generated at compile time from a fixed seed, so a position has the same key in every run and
+// every build. Anything stored by key (hash table snapshots, opening books, perft caches) should be saved together
+// with zobristVersion, which has to be bumped whenever the seed, the generator or the key layout changes.
+constexpr uint32_t zobristVersion = 1;
+constexpr uint64_t zobristSeed = 0x9E3779B97F4A7C15ULL;
+
+// SplitMix64, advances state and returns the next key
+constexpr uint64_t nextZobristKey(uint64_t& state) {
+    state += 0x9E3779B97F4A7C15ULL;
+
+    uint64_t key = state;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+
+    return key ^ (key >> 31);
+}
+
 class BoardHashing {
 public:
-    std::array<std::array<uint64_t, numBoardSquares>, 12> pieceRandomNumbers;
+    std::array<std::array<uint64_t, numBoardSquares>, 12> pieceRandomNumbers {};
+
+    std::array<uint64_t, 2> turnRandomNumber {};
 
-    std::array<uint64_t, 2> turnRandomNumber;
+    // Indexed by the castle rights bit set and by the en passant column
+    std::array<uint64_t, allCastleRights + 1> castleRandomNumbers {};
+    std::array<uint64_t, boardSize> enPassantRandomNumbers {};
 
 
-    BoardHashing();
+    constexpr explicit BoardHashing(uint64_t seed) {
+        uint64_t state = seed;
+
+        for (auto& squares : pieceRandomNumbers) {
+            for (uint64_t& number : squares) {
+                number = nextZobristKey(state);
+            }
+        }
+
+        for (uint64_t& number : turnRandomNumber) {
+            number = nextZobristKey(state);
+        }
+
+        for (uint64_t& number : castleRandomNumbers) {
+            number = nextZobristKey(state);
+        }
+
+        for (uint64_t& number : enPassantRandomNumbers) {
+            number = nextZobristKey(state);
+        }
+    }
 };
+
+// Shared by every board
+inline constexpr BoardHashing boardHashing { zobristSeed };
+
+#endif
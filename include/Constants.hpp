@@ -2,8 +2,10 @@
 #define CONSTANTS_H
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 constexpr int boardSize = 8;
@@ -11,8 +13,12 @@ constexpr int numBoardSquares = 64;
 const std::string defaultBoardPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
 constexpr int numTypesPieces = 12;
 
+// Plies the undo stack is sized for up front, deeper searches and long games still work but reallocate
+constexpr size_t maxSearchPly = 256;
+
 
 enum PieceTypes : std::int8_t {
+    noPiece = -1,
     blackPawn,
     blackKnight,
     blackBishop,
@@ -27,6 +33,58 @@ enum PieceTypes : std::int8_t {
     whiteKing
 };
 
+constexpr int numPieceKinds = 6;
+
+enum PieceKind : std::int8_t { pawn, knight, bishop, rook, queen, king };
+
+// Material value of every kind without the square bonus, used to order captures
+constexpr std::array<int, numPieceKinds> pieceValues = { 100, 300, 300, 500, 900, 20000 };
+
+enum class Color : std::uint8_t { black, white };
+
+constexpr Color opposite(Color color) {
+    return color == Color::white ? Color::black : Color::white;
+}
+
+// Pawn to king for either colour
+constexpr int pieceKind(int pieceType) {
+    return pieceType >= whitePawn ? pieceType - numPieceKinds : pieceType;
+}
+
+// 0 for black, 1 for white
+constexpr int pieceColor(int pieceType) {
+    return pieceType >= whitePawn ? 1 : 0;
+}
+
+
+constexpr int noSquare = -1;
+
+enum CastleRights : std::uint8_t {
+    whiteKingSide = 1,
+    whiteQueenSide = 2,
+    blackKingSide = 4,
+    blackQueenSide = 8,
+    allCastleRights = 15
+};
+
+// Castle rights kept when a piece moves from or to each square, so a king or rook leaving its starting square or a
+// rook being captured clears the matching rights
+constexpr std::array<int, numBoardSquares> generateCastleRightsMask() {
+    std::array<int, numBoardSquares> mask {};
+    mask.fill(allCastleRights);
+
+    mask[0] = allCastleRights & ~blackQueenSide;
+    mask[4] = allCastleRights & ~(blackKingSide | blackQueenSide);
+    mask[7] = allCastleRights & ~blackKingSide;
+    mask[56] = allCastleRights & ~whiteQueenSide;
+    mask[60] = allCastleRights & ~(whiteKingSide | whiteQueenSide);
+    mask[63] = allCastleRights & ~whiteKingSide;
+
+    return mask;
+}
+
+constexpr std::array<int, numBoardSquares> castleRightsMask = generateCastleRightsMask();
+
 
 constexpr uint64_t pawnAttackingLeft = ~0x8080808080808080;
 constexpr uint64_t pawnAttackingRight = ~0x0101010101010101;
@@ -39,21 +97,44 @@ constexpr uint64_t columnMasks(int column) {
     return 0x0101010101010101ULL << column;
 }
 
+// Positive steps move towards higher squares (down and right), negative steps towards lower squares
+constexpr uint64_t shiftBitboard(uint64_t bitboard, int step) {
+    return step > 0 ? bitboard << step : bitboard >> -step;
+}
+
 
-struct Position {
-    int row;
-    int column;
-    Position(int row, int column)
-        : row(row)
-        , column(column) {}
-};
+// Squares reached from each square by a single step of (row, column) offsets, ignoring steps that leave the board
+template <size_t N>
+constexpr std::array<uint64_t, numBoardSquares> generateStepAttacks(const std::array<std::pair<int, int>, N>& offsets) {
+    std::array<uint64_t, numBoardSquares> attacks {};
 
-constexpr std::array<int, 8> knightOffsets = { 17, 15, 10, 6, -6, -10, -15, -17 };
-constexpr std::array<int, 4> straightDirections = { -boardSize, boardSize, -1, 1 };
-constexpr std::array<int, 4> diagonalDirections = { -boardSize - 1, -boardSize + 1, boardSize - 1, boardSize + 1 };
+    for (int square = 0; square < numBoardSquares; ++square) {
+        for (auto [rowOffset, colOffset] : offsets) {
+            int row = square / boardSize + rowOffset;
+            int col = square % boardSize + colOffset;
 
-constexpr std::array<int, 8> kingDirections
-  = { -boardSize - 1, -boardSize, -boardSize + 1, -1, 1, boardSize - 1, boardSize, boardSize + 1 };
+            if (row >= 0 && row < boardSize && col >= 0 && col < boardSize) {
+                attacks[static_cast<size_t>(square)] |= 1ULL << (row * boardSize + col);
+            }
+        }
+    }
+
+    return attacks;
+}
+
+constexpr std::array<uint64_t, numBoardSquares> knightAttacks = generateStepAttacks<8>({
+  { { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 }, { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 } }
+});
+
+constexpr std::array<uint64_t, numBoardSquares> kingAttacks = generateStepAttacks<8>({
+  { { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } }
+});
+
+// Indexed by colour, black first like PieceTypes. White pawns attack towards row 0, black pawns towards row 7.
+constexpr std::array<std::array<uint64_t, numBoardSquares>, 2> pawnAttacks = {
+    generateStepAttacks<2>({ { { 1, -1 }, { 1, 1 } } }),
+    generateStepAttacks<2>({ { { -1, -1 }, { -1, 1 } } }),
+};
 
 
 inline char getCharFromPieceType(PieceTypes piece) {
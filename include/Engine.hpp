@@ -11,6 +11,7 @@
 
 #include "Board.hpp"
 #include "Move.hpp"
+#include "MoveList.hpp"
 #include "Worker.hpp"
 
 struct MoveProcessing {
@@ -19,7 +20,7 @@ struct MoveProcessing {
     double eval;
 
     MoveProcessing() = default;
-    MoveProcessing(const Move& move, int depth, double eval)
+    MoveProcessing(Move move, int depth, double eval)
         : move(move)
         , depth(depth)
         , eval(eval) {}
@@ -74,7 +75,7 @@ private:
 
     std::mutex moveMutex;
 
-    std::vector<Move> moves;
+    MoveList moves;
 
     std::priority_queue<MoveProcessing, std::vector<MoveProcessing>,
                         std::function<bool(const MoveProcessing&, const MoveProcessing&)>>
@@ -86,6 +87,7 @@ private:
     std::condition_variable doneCondition;
 
 
+    // Threads working on a move, the search is done once it is 0 and nothing is queued
     std::atomic<size_t> activeThreads { 0 };
 
     bool stop;
@@ -99,6 +101,9 @@ private:
 
     std::atomic<size_t> totalPositionsEvaluated;
 
+    // Progress of every search printed to cout
+    bool logging = true;
+
 
     WhiteProccessingOrderFunctor whitePQFunctor;
     BlackProcessingOrderFunctor blackPQFunctor;
@@ -109,7 +114,7 @@ private:
 
 
 public:
-    Engine(std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing);
+    Engine();
     Engine(int threadNum, const Board& board, int depth);
     ~Engine();
 
@@ -121,5 +126,10 @@ public:
 
     Move findBestMove();
 
-    void processMove(const Move& move);
+    void processMove(Move move);
+
+    // Positions evaluated by the last findBestMove
+    size_t getPositionsEvaluated() const { return totalPositionsEvaluated; }
+
+    void setLogging(bool enabled) { logging = enabled; }
 };
@@ -11,12 +11,11 @@ private:
     Engine engine;
 
 public:
-    Game(std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing)
-        : Game(1, defaultBoardPosition, 3, knightMoves, boardHashing) {};
+    Game()
+        : Game(1, defaultBoardPosition, 3) {};
 
-    Game(int threadNum, const std::string& fen, int depth, std::array<uint64_t, numBoardSquares>* knightMoves,
-         BoardHashing& boardHashing)
-        : currentBoard(fen, knightMoves, boardHashing)
+    Game(int threadNum, const std::string& fen, int depth)
+        : currentBoard(fen)
         , engine(threadNum, currentBoard, depth) {};
 
     void runGame();
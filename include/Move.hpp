@@ -1,28 +1,67 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include <cstdint>
 #include <iostream>
+#include <type_traits>
 
 #include "Constants.hpp"
 
+// A move packed into 16 bits: start square in bits 0-5, end square in bits 6-11 and the flags in bits 12-15.
+// The flags follow the usual layout where bit 2 marks a capture and bit 3 a promotion, with the low two bits
+// holding the promotion piece (knight, bishop, rook, queen) for promotions.
 struct Move {
-    uint64_t start;
-    uint64_t end;
+    enum Flags : uint16_t {
+        quiet = 0,
+        doublePawnPush = 1,
+        kingCastle = 2,
+        queenCastle = 3,
+        capture = 4,
+        enPassantCapture = 5,
+        knightPromotion = 8,
+        bishopPromotion = 9,
+        rookPromotion = 10,
+        queenPromotion = 11,
+        knightPromotionCapture = 12,
+        bishopPromotionCapture = 13,
+        rookPromotionCapture = 14,
+        queenPromotionCapture = 15,
+    };
+
+    uint16_t data;
+
     Move() = default;
 
-    Move(uint64_t start, uint64_t end)
-        : start(start)
-        , end(end) {}
+    constexpr Move(int startSquare, int endSquare, uint16_t flags = quiet)
+        : data(static_cast<uint16_t>(startSquare | (endSquare << 6) | (flags << 12))) {}
+
+    constexpr int startSquare() const { return data & 0x3F; }
+    constexpr int endSquare() const { return (data >> 6) & 0x3F; }
+    constexpr uint16_t flags() const { return static_cast<uint16_t>(data >> 12); }
 
+    constexpr uint64_t startMask() const { return 1ULL << startSquare(); }
+    constexpr uint64_t endMask() const { return 1ULL << endSquare(); }
+
+    constexpr bool isCapture() const { return (flags() & capture) != 0; }
+    constexpr bool isPromotion() const { return (flags() & knightPromotion) != 0; }
+    constexpr bool isCastle() const { return flags() == kingCastle || flags() == queenCastle; }
+    constexpr bool isEnPassant() const { return flags() == enPassantCapture; }
+
+    constexpr bool operator==(const Move& other) const = default;
 
     friend std::ostream& operator<<(std::ostream& os, const Move& move) {
-        os << "(" << __builtin_ctzll(move.start) / boardSize << ", " << __builtin_ctzll(move.start) % boardSize << ")"
+        os << "(" << move.startSquare() / boardSize << ", " << move.startSquare() % boardSize << ")"
            << " -> "
-           << "(" << __builtin_ctzll(move.end) / boardSize << ", " << __builtin_ctzll(move.end) % boardSize << ")";
+           << "(" << move.endSquare() / boardSize << ", " << move.endSquare() % boardSize << ")";
 
 
         return os;
     };
 };
 
+// a8 to a8, never a real move, so it marks an empty hash move or killer slot
+inline constexpr Move noMove { 0, 0 };
+
+static_assert(sizeof(Move) == 2 && std::is_trivially_default_constructible_v<Move>);
+
 #endif
@@ -0,0 +1,52 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+#include "Move.hpp"
+
+// No legal chess position has more than 218 moves
+constexpr size_t maxMoves = 256;
+
+// Move container with inline storage, so a search node can keep its moves on the stack instead of the heap. Move is
+// trivially default constructible, so the storage is left uninitialized until moves are added.
+class MoveList {
+private:
+    std::array<Move, maxMoves> moves;
+    size_t currentSize = 0;
+
+public:
+    void push_back(Move move) {
+        assert(currentSize < maxMoves);
+        moves[currentSize++] = move;
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        assert(currentSize < maxMoves);
+        moves[currentSize++] = Move(std::forward<Args>(args)...);
+    }
+
+    void pop_back() { --currentSize; }
+
+    void clear() { currentSize = 0; }
+
+    Move operator[](size_t index) const { return moves[index]; }
+    Move& operator[](size_t index) { return moves[index]; }
+
+    Move back() const { return moves[currentSize - 1]; }
+
+    size_t size() const { return currentSize; }
+    bool empty() const { return currentSize == 0; }
+
+    Move* begin() { return moves.data(); }
+    const Move* begin() const { return moves.data(); }
+
+    Move* end() { return moves.data() + currentSize; }
+    const Move* end() const { return moves.data() + currentSize; }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveList.hpp"
+
+// Quiet moves remembered per ply because they caused a cutoff in a sibling node
+constexpr size_t numKillers = 2;
+
+using Killers = std::array<Move, numKillers>;
+
+// Hands out the legal moves of a node one at a time in the order hash move, winning captures, killers, quiet moves
+// and losing captures. Every stage is only generated once the previous one is used up, so a node that cuts off on
+// the hash move or a capture never generates its quiet moves.
+template <Color Us>
+class MovePicker {
+private:
+    enum class Stage : std::uint8_t {
+        hashMove,
+        generateCaptures,
+        winningCaptures,
+        killers,
+        generateQuiets,
+        quiets,
+        losingCaptures,
+        done
+    };
+
+    const Board& board;
+
+    Stage stage = Stage::hashMove;
+
+    LegalMasks masks;
+
+    // Both come from other searches, a key collision or a sibling position, so they are validated before use
+    Move hashMove;
+    Killers killers;
+
+    bool skipLosingCaptures;
+
+    MoveList captures;
+    std::array<int, maxMoves> captureScores;
+    MoveList losingCaptures;
+    MoveList quiets;
+
+    size_t index = 0;
+    size_t killerIndex = 0;
+    size_t movesPicked = 0;
+
+    void generateCaptures();
+    bool isKiller(Move move) const;
+
+public:
+    // With skipLosingCaptures the captures that lose material are left out, unless they are the only legal moves
+    MovePicker(const Board& board, Move hashMove, const Killers& killers, bool skipLosingCaptures = false);
+
+    // Sets move to the next move to search, false once every legal move has been handed out
+    bool next(Move& move);
+
+    // Zero after next returned false means the side to move has no legal moves
+    size_t picked() const { return movesPicked; }
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "MoveList.hpp"
+#include "Position.hpp"
+
+// Leaf counts of subtrees shared by every perft thread, keyed by the Zobrist key and the remaining depth
+class PerftHash {
+private:
+    // The key is stored XORed with the data, so an entry torn by two threads writing at once fails the key check
+    // instead of returning a wrong count, and no lock is needed
+    struct Entry {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    // The depth is kept in the top byte of the data and the leaf count in the rest
+    static constexpr int depthShift = 56;
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t indexMask = 0;
+
+public:
+    // The table is rounded down to a power of two entries, 0 megabytes turns it off
+    explicit PerftHash(size_t megabytes);
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+    void store(uint64_t key, int depth, uint64_t nodes);
+
+    void clear();
+};
+
+// Counts the leaf nodes of the legal move tree, to compare the move generator against known counts and to measure
+// its speed apart from the search
+class Perft {
+private:
+    Board board;
+
+    size_t threadNum;
+
+    PerftHash hash;
+
+    // A subtree below the root, the position after a root move and one reply
+    struct Task {
+        Position position;
+        int depth;
+        size_t rootIndex;
+    };
+
+    // Every thread works from the back of its own queue and steals from the front of the others once it is empty
+    std::vector<std::deque<Task>> queues;
+    std::vector<std::mutex> queueMutexes;
+
+    // The last ply is counted from the size of the legal move list without making the moves
+    template <Color Us>
+    uint64_t count(Board& threadBoard, int depth);
+    uint64_t count(Board& threadBoard, int depth);
+
+    bool nextTask(size_t index, Task& task);
+    void workerTask(size_t index, std::vector<std::atomic<uint64_t>>& rootNodes);
+
+    // Leaf count below every root move, counted by threads threads
+    std::vector<uint64_t> run(const MoveList& rootMoves, int depth, size_t threads);
+
+public:
+    Perft(const Board& board, size_t threadNum = 1, size_t hashMegabytes = 0);
+
+    uint64_t count(int depth);
+
+    // Prints the leaf count below every root move, then the total and the nodes per second
+    uint64_t divide(int depth);
+
+    // Counts the tree with 1, 2, 4 ... threadNum threads and prints the time and speedup of each, starting every run
+    // with an empty hash
+    void scaling(int depth);
+};
+
+#endif
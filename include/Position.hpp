@@ -0,0 +1,48 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Constants.hpp"
+
+// Everything that describes a position, kept small and trivially copyable so handing a position to another thread
+// or copying it for a search is a plain memcpy of a few cache lines. Zobrist keys and attack tables are global and
+// shared by every board.
+struct Position {
+    // Pieces by kind (pawn to king) regardless of colour, and by colour (black, white)
+    std::array<uint64_t, numPieceKinds> kindBB;
+    std::array<uint64_t, 2> colorBB;
+
+    // The piece on every square, or noPiece
+    std::array<PieceTypes, numBoardSquares> pieceOn;
+
+    uint64_t hashKey;
+    double eval;
+
+    int8_t castleRights;
+
+    // Square a pawn skipped over with its last double push, noSquare otherwise
+    int8_t enPassantSquare;
+
+    // Plies since the last capture or pawn move
+    uint8_t halfmoveClock;
+
+    bool whiteTurn;
+
+    template <Color Us>
+    uint64_t pieces(PieceKind kind) const {
+        return kindBB[static_cast<size_t>(kind)] & colorBB[static_cast<size_t>(Us)];
+    }
+
+    uint64_t pieces(int pieceType) const {
+        return kindBB[static_cast<size_t>(pieceKind(pieceType))] & colorBB[static_cast<size_t>(pieceColor(pieceType))];
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Position>);
+static_assert(sizeof(Position) <= 160);
+
+#endif
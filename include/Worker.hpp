@@ -1,9 +1,12 @@
+#include <array>
 #include <climits>
 #include <cstddef>
 #include <unordered_map>
 
 #include "Board.hpp"
+#include "Constants.hpp"
 #include "Move.hpp"
+#include "MovePicker.hpp"
 
 struct WorkerResult {
     double eval;
@@ -25,16 +28,37 @@ private:
 
     std::unordered_map<uint64_t, double> boardHashes;
 
+    // Best move found in every searched position, kept across the root moves and iterations of one board position
+    // so the next search of a position tries it first
+    std::unordered_map<uint64_t, Move> hashMoves;
+
+    // Indexed by the ply below the root move
+    std::array<Killers, maxSearchPly> killers {};
+
     size_t totalEvaluations {};
     size_t totalSamePositionsFound {};
 
+    // The search is templated on the side that plays the move, so the side to move after it and the direction of
+    // the window are known at compile time at every ply
+    template <Color Us>
+    WorkerResult generateBestMove(int depth, Move move, double alpha, double beta);
+    template <Color Us>
+    double alphaBetaPruning(Move move, int depth, size_t ply, double alpha, double beta);
+
+    // Searches the moves of the side to move in the order the picker hands them out and narrows the window in
+    // place, returning the best score found
+    template <Color Us>
+    double searchMoves(MovePicker<Us>& picker, int depth, size_t ply, double& alpha, double& beta);
+
+    Move hashMove(uint64_t hash) const;
+    void storeKiller(size_t ply, Move move);
+
 public:
     Worker(const Board& board)
-        : board(board) {}
+        : board(board.getPosition()) {}
 
-    WorkerResult generateBestMove(int depth, const Move& move, double alpha, double beta);
-    void processMove(const Move& move);
-    double alphaBetaPruning(const Move& move, int depth, double alpha, double beta);
+    WorkerResult generateBestMove(int depth, Move move, double alpha, double beta);
+    void processMove(Move move);
 
     void setBoard(const Board& newBoard);
 
@@ -0,0 +1,170 @@
+#include "AttackMap.hpp"
+
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "Constants.hpp"
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t allSquares = ~0ULL;
+constexpr uint64_t notColumnA = ~columnMasks(0);
+constexpr uint64_t notColumnH = ~columnMasks(boardSize - 1);
+constexpr uint64_t notColumnsAB = ~(columnMasks(0) | columnMasks(1));
+constexpr uint64_t notColumnsGH = ~(columnMasks(boardSize - 2) | columnMasks(boardSize - 1));
+
+// Kogge-Stone occluded fill: every square reachable from the generators along one direction without crossing an
+// occupied square. wrapMask removes squares that would wrap around to the other side of the board.
+constexpr uint64_t occludedFill(uint64_t generators, uint64_t empty, int step, uint64_t wrapMask) {
+    uint64_t propagators = empty & wrapMask;
+
+    generators |= propagators & shiftBitboard(generators, step);
+    propagators &= shiftBitboard(propagators, step);
+    generators |= propagators & shiftBitboard(generators, 2 * step);
+    propagators &= shiftBitboard(propagators, 2 * step);
+    generators |= propagators & shiftBitboard(generators, 4 * step);
+
+    return generators;
+}
+
+// The fill includes the generators themselves, so the king and pawns can ride along in the final one-step shift
+constexpr uint64_t directionAttacks(uint64_t sliders, uint64_t steppers, uint64_t empty, int step, uint64_t wrapMask) {
+    return shiftBitboard(occludedFill(sliders, empty, step, wrapMask) | steppers, step) & wrapMask;
+}
+
+constexpr uint64_t knightAttackMap(uint64_t knights) {
+    return (shiftBitboard(knights, 6) & notColumnsGH) | (shiftBitboard(knights, 10) & notColumnsAB)
+         | (shiftBitboard(knights, 15) & notColumnH) | (shiftBitboard(knights, 17) & notColumnA)
+         | (shiftBitboard(knights, -6) & notColumnsAB) | (shiftBitboard(knights, -10) & notColumnsGH)
+         | (shiftBitboard(knights, -15) & notColumnA) | (shiftBitboard(knights, -17) & notColumnH);
+}
+
+bool cpuSupportsAvx2() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+const bool useAvx2 = cpuSupportsAvx2();
+
+}   // namespace
+
+uint64_t attackMapScalar(const AttackingPieces& pieces, uint64_t occupied) {
+    uint64_t empty = ~occupied;
+
+    // White pawns attack towards lower squares, black pawns towards higher squares
+    uint64_t whiteMask = 0 - static_cast<uint64_t>(pieces.white);
+    uint64_t whitePawns = pieces.pawns & whiteMask;
+    uint64_t blackPawns = pieces.pawns & ~whiteMask;
+
+    uint64_t straight = pieces.straightSliders;
+    uint64_t diagonal = pieces.diagonalSliders;
+    uint64_t king = pieces.king;
+
+    return directionAttacks(straight, king, empty, 1, notColumnA)
+         | directionAttacks(straight, king, empty, -1, notColumnH)
+         | directionAttacks(straight, king, empty, boardSize, allSquares)
+         | directionAttacks(straight, king, empty, -boardSize, allSquares)
+         | directionAttacks(diagonal, king | blackPawns, empty, boardSize - 1, notColumnH)
+         | directionAttacks(diagonal, king | blackPawns, empty, boardSize + 1, notColumnA)
+         | directionAttacks(diagonal, king | whitePawns, empty, -(boardSize - 1), notColumnA)
+         | directionAttacks(diagonal, king | whitePawns, empty, -(boardSize + 1), notColumnH)
+         | knightAttackMap(pieces.knights);
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+// Packs one value per lane, in the lane order used by attackMapAvx2
+__attribute__((target("avx2"), always_inline)) inline __m256i lanes(uint64_t lane0, uint64_t lane1, uint64_t lane2,
+                                                                  uint64_t lane3) {
+    return _mm256_set_epi64x(static_cast<long long>(lane3), static_cast<long long>(lane2),
+                             static_cast<long long>(lane1), static_cast<long long>(lane0));
+}
+
+}   // namespace
+
+// Runs the eight sliding directions as two vectors of four lanes, one shifting towards higher squares and one
+// towards lower squares. Lane steps are 1, 7, 8 and 9 squares.
+__attribute__((target("avx2"))) uint64_t attackMapAvx2(const AttackingPieces& pieces, uint64_t occupied) {
+    const __m256i step1 = lanes(1, 7, 8, 9);
+    const __m256i step2 = _mm256_slli_epi64(step1, 1);
+    const __m256i step4 = _mm256_slli_epi64(step1, 2);
+
+    const __m256i higherWrap = lanes(notColumnA, notColumnH, allSquares, notColumnA);
+    const __m256i lowerWrap = lanes(notColumnH, notColumnA, allSquares, notColumnH);
+
+    uint64_t whiteMask = 0 - static_cast<uint64_t>(pieces.white);
+    uint64_t whitePawns = pieces.pawns & whiteMask;
+    uint64_t blackPawns = pieces.pawns & ~whiteMask;
+
+    const __m256i sliders
+      = lanes(pieces.straightSliders, pieces.diagonalSliders, pieces.straightSliders, pieces.diagonalSliders);
+    const __m256i king = _mm256_set1_epi64x(static_cast<long long>(pieces.king));
+    const __m256i empty = _mm256_set1_epi64x(static_cast<long long>(~occupied));
+
+    // Towards higher squares
+    __m256i generators = sliders;
+    __m256i propagators = _mm256_and_si256(empty, higherWrap);
+
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, step1)));
+    propagators = _mm256_and_si256(propagators, _mm256_sllv_epi64(propagators, step1));
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, step2)));
+    propagators = _mm256_and_si256(propagators, _mm256_sllv_epi64(propagators, step2));
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, step4)));
+
+    generators = _mm256_or_si256(generators, _mm256_or_si256(king, lanes(0, blackPawns, 0, blackPawns)));
+    __m256i attacks = _mm256_and_si256(_mm256_sllv_epi64(generators, step1), higherWrap);
+
+    // Towards lower squares
+    generators = sliders;
+    propagators = _mm256_and_si256(empty, lowerWrap);
+
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, step1)));
+    propagators = _mm256_and_si256(propagators, _mm256_srlv_epi64(propagators, step1));
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, step2)));
+    propagators = _mm256_and_si256(propagators, _mm256_srlv_epi64(propagators, step2));
+    generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, step4)));
+
+    generators = _mm256_or_si256(generators, _mm256_or_si256(king, lanes(0, whitePawns, 0, whitePawns)));
+    attacks = _mm256_or_si256(attacks, _mm256_and_si256(_mm256_srlv_epi64(generators, step1), lowerWrap));
+
+    // Knight jumps of 6, 10, 15 and 17 squares in both directions
+    const __m256i knightSteps = lanes(6, 10, 15, 17);
+    const __m256i knightHigherWrap = lanes(notColumnsGH, notColumnsAB, notColumnH, notColumnA);
+    const __m256i knightLowerWrap = lanes(notColumnsAB, notColumnsGH, notColumnA, notColumnH);
+    const __m256i knights = _mm256_set1_epi64x(static_cast<long long>(pieces.knights));
+
+    attacks = _mm256_or_si256(attacks, _mm256_and_si256(_mm256_sllv_epi64(knights, knightSteps), knightHigherWrap));
+    attacks = _mm256_or_si256(attacks, _mm256_and_si256(_mm256_srlv_epi64(knights, knightSteps), knightLowerWrap));
+
+    __m128i combined = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    combined = _mm_or_si128(combined, _mm_unpackhi_epi64(combined, combined));
+
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(combined));
+}
+
+#else
+
+uint64_t attackMapAvx2(const AttackingPieces& pieces, uint64_t occupied) {
+    return attackMapScalar(pieces, occupied);
+}
+
+#endif
+
+uint64_t attackMap(const AttackingPieces& pieces, uint64_t occupied) {
+    return useAvx2 ? attackMapAvx2(pieces, occupied) : attackMapScalar(pieces, occupied);
+}
+
+bool attackMapUsesAvx2() {
+    return useAvx2;
+}
@@ -0,0 +1,168 @@
+#include "Attacks.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#include "Constants.hpp"
+
+using namespace std;
+
+array<Magic, numBoardSquares> rookMagics;
+array<Magic, numBoardSquares> bishopMagics;
+
+namespace {
+
+// Sum over all squares of 2^(relevant occupancy bits)
+constexpr size_t rookTableSize = 102400;
+constexpr size_t bishopTableSize = 5248;
+
+array<uint64_t, rookTableSize> rookTable;
+array<uint64_t, bishopTableSize> bishopTable;
+
+using Directions = array<pair<int, int>, 4>;
+
+constexpr Directions rookDirections = {
+    { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } }
+};
+constexpr Directions bishopDirections = {
+    { { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } }
+};
+
+// Magic numbers for this board's square numbering (a8 = 0), found offline with a sparse random search
+constexpr array<uint64_t, numBoardSquares> rookMagicNumbers = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+constexpr array<uint64_t, numBoardSquares> bishopMagicNumbers = {
+    0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL, 0x5204042080000088ULL,
+    0x2204106880000002ULL, 0x1401042004000000ULL, 0x0400880410042004ULL, 0x0028208200A02020ULL,
+    0x1500241990010E00ULL, 0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+    0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL, 0x8000088400880520ULL,
+    0x0405004010040100ULL, 0x1005823210040108ULL, 0x2708008102040011ULL, 0x4048200404009100ULL,
+    0x0018104101400024ULL, 0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+    0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL, 0x0894080000220040ULL,
+    0x1001010083104000ULL, 0x5004030040900080ULL, 0x000400422C012400ULL, 0x0002128698404812ULL,
+    0x1010108404900440ULL, 0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+    0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL, 0x802A02020000B098ULL,
+    0x0009015090004060ULL, 0x4000821082081001ULL, 0x0100210040420800ULL, 0x0800004010488A00ULL,
+    0x2000081104004040ULL, 0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+    0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL, 0x3040290220884800ULL,
+    0x4A1500401041004AULL, 0x8010200282020781ULL, 0x0020203142209091ULL, 0x0070300600902110ULL,
+    0x0040808800B62048ULL, 0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+    0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL, 0x4040702400932244ULL
+};
+
+// Reference ray walk, only used while building the tables
+uint64_t slidingAttacks(int square, uint64_t occupied, const Directions& directions) {
+    uint64_t attacks = 0;
+
+    for (auto [rowStep, colStep] : directions) {
+        int row = square / boardSize + rowStep;
+        int col = square % boardSize + colStep;
+
+        while (row >= 0 && row < boardSize && col >= 0 && col < boardSize) {
+            uint64_t squareMask = 1ULL << (row * boardSize + col);
+            attacks |= squareMask;
+
+            if ((occupied & squareMask) != 0) {
+                break;
+            }
+
+            row += rowStep;
+            col += colStep;
+        }
+    }
+
+    return attacks;
+}
+
+SliderBackend selectedBackend = SliderBackend::magic;
+
+bool cpuSupportsPext() {
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("bmi2") != 0;
+#else
+    return false;
+#endif
+}
+
+void initMagics(array<Magic, numBoardSquares>& magics, uint64_t* table,
+                const array<uint64_t, numBoardSquares>& magicNumbers, const Directions& directions, bool pext) {
+    for (int square = 0; square < numBoardSquares; ++square) {
+        int row = square / boardSize;
+        int col = square % boardSize;
+
+        // Pieces on the board edge never block anything further along the ray
+        uint64_t edges = ((rowMasks(0) | rowMasks(boardSize - 1)) & ~rowMasks(row))
+                       | ((columnMasks(0) | columnMasks(boardSize - 1)) & ~columnMasks(col));
+
+        Magic& magic = magics[static_cast<size_t>(square)];
+        magic.mask = slidingAttacks(square, 0, directions) & ~edges;
+        magic.magic = magicNumbers[static_cast<size_t>(square)];
+        magic.shift = static_cast<unsigned>(numBoardSquares - __builtin_popcountll(magic.mask));
+        magic.attacks = table;
+        magic.pext = pext;
+
+        // Carry-Rippler enumeration of every subset of the mask
+        uint64_t subset = 0;
+        do {
+            table[magic.index(subset)] = slidingAttacks(square, subset, directions);
+            subset = (subset - magic.mask) & magic.mask;
+        } while (subset != 0);
+
+        table += 1ULL << __builtin_popcountll(magic.mask);
+    }
+}
+
+}   // namespace
+
+void initAttackTables(SliderBackend backend) {
+    bool pextAvailable = cpuSupportsPext();
+
+    if (backend == SliderBackend::automatic) {
+        backend = pextAvailable ? SliderBackend::pext : SliderBackend::magic;
+    } else if (backend == SliderBackend::pext && !pextAvailable) {
+        cerr << "BMI2 is not supported on this CPU, using magic slider attacks\n";
+        backend = SliderBackend::magic;
+    }
+
+    selectedBackend = backend;
+
+    bool pext = backend == SliderBackend::pext;
+
+    initMagics(rookMagics, rookTable.data(), rookMagicNumbers, rookDirections, pext);
+    initMagics(bishopMagics, bishopTable.data(), bishopMagicNumbers, bishopDirections, pext);
+}
+
+SliderBackend activeSliderBackend() {
+    return selectedBackend;
+}
+
+const char* sliderBackendName(SliderBackend backend) {
+    switch (backend) {
+    case SliderBackend::magic:
+        return "magic";
+    case SliderBackend::pext:
+        return "pext";
+    default:
+        return "auto";
+    }
+}
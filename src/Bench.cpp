@@ -0,0 +1,147 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchPositions.hpp"
+#include "Board.hpp"
+#include "Engine.hpp"
+#include "Move.hpp"
+
+using namespace std;
+
+namespace {
+
+struct SearchResult {
+    uint64_t nodes;
+    double seconds;
+    Move move;
+};
+
+SearchResult searchPosition(const string& fen, int depth, size_t threads) {
+    Engine engine(static_cast<int>(threads), Board(fen), depth);
+    engine.setLogging(false);
+
+    auto startTime = chrono::steady_clock::now();
+    Move move = engine.findBestMove();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    return { engine.getPositionsEvaluated(), seconds, move };
+}
+
+uint64_t nodesPerSecond(uint64_t nodes, double seconds) {
+    return static_cast<uint64_t>(static_cast<double>(nodes) / seconds);
+}
+
+// Share of nodes searched on top of the one thread search
+double nodeOverhead(uint64_t nodes, uint64_t oneThreadNodes) {
+    return (static_cast<double>(nodes) - static_cast<double>(oneThreadNodes)) / static_cast<double>(oneThreadNodes);
+}
+
+}   // namespace
+
+uint64_t runBench(int depth) {
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+
+    for (size_t index = 0; index < searchBenchPositions.size(); ++index) {
+        SearchResult result = searchPosition(searchBenchPositions[index], depth, 1);
+
+        cout << "Position " << index + 1 << ": " << result.nodes << " nodes, best move " << result.move << "\n";
+
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+    }
+
+    cout << "\nDepth: " << depth << "\n";
+    cout << "Nodes: " << totalNodes << "\n";
+    cout << "Time: " << totalSeconds << " seconds\n";
+    cout << "NPS: " << nodesPerSecond(totalNodes, totalSeconds) << "\n";
+
+    return totalNodes;
+}
+
+void runBenchScaling(int depth, size_t maxThreads) {
+    maxThreads = max<size_t>(maxThreads, 1);
+
+    // Every thread count runs the same positions, indexed [thread count][position]
+    vector<size_t> threadCounts;
+    vector<vector<SearchResult>> results;
+
+    for (size_t threads = 1;; threads = min(threads * 2, maxThreads)) {
+        threadCounts.push_back(threads);
+        results.emplace_back();
+
+        for (const string& fen : searchBenchPositions) {
+            results.back().push_back(searchPosition(fen, depth, threads));
+        }
+
+        if (threads >= maxThreads) {
+            break;
+        }
+    }
+
+    auto totalNodes = [](const vector<SearchResult>& runs) {
+        uint64_t nodes = 0;
+
+        for (const SearchResult& result : runs) {
+            nodes += result.nodes;
+        }
+
+        return nodes;
+    };
+
+    auto totalSeconds = [](const vector<SearchResult>& runs) {
+        double seconds = 0.0;
+
+        for (const SearchResult& result : runs) {
+            seconds += result.seconds;
+        }
+
+        return seconds;
+    };
+
+    uint64_t oneThreadNodes = totalNodes(results[0]);
+    double oneThreadSeconds = totalSeconds(results[0]);
+
+    cout << "Depth " << depth << " over " << searchBenchPositions.size() << " positions\n\n";
+    cout << setw(8) << "Threads" << setw(12) << "Seconds" << setw(14) << "Nodes" << setw(14) << "NPS" << setw(10)
+         << "Speedup" << setw(12) << "Efficiency" << setw(16) << "Node overhead" << "\n";
+
+    for (size_t run = 0; run < threadCounts.size(); ++run) {
+        uint64_t nodes = totalNodes(results[run]);
+        double seconds = totalSeconds(results[run]);
+        double speedup = oneThreadSeconds / seconds;
+
+        cout << fixed << setprecision(3) << setw(8) << threadCounts[run] << setw(12) << seconds << setw(14) << nodes
+             << setw(14) << nodesPerSecond(nodes, seconds) << setprecision(2) << setw(10) << speedup << setw(11)
+             << speedup / static_cast<double>(threadCounts[run]) * 100 << "%" << setw(15)
+             << nodeOverhead(nodes, oneThreadNodes) * 100 << "%\n";
+    }
+
+    // One row per position and thread count, then the totals of every thread count as position "total"
+    cout << "\nthreads,position,seconds,nodes,nps,speedup,efficiency,node_overhead\n";
+
+    for (size_t run = 0; run < threadCounts.size(); ++run) {
+        for (size_t position = 0; position <= searchBenchPositions.size(); ++position) {
+            bool total = position == searchBenchPositions.size();
+
+            uint64_t nodes = total ? totalNodes(results[run]) : results[run][position].nodes;
+            double seconds = total ? totalSeconds(results[run]) : results[run][position].seconds;
+            uint64_t baseNodes = total ? oneThreadNodes : results[0][position].nodes;
+            double baseSeconds = total ? oneThreadSeconds : results[0][position].seconds;
+            double speedup = baseSeconds / seconds;
+
+            cout << threadCounts[run] << "," << (total ? "total" : to_string(position + 1)) << "," << setprecision(6)
+                 << seconds << "," << nodes << "," << nodesPerSecond(nodes, seconds) << "," << setprecision(4)
+                 << speedup << "," << speedup / static_cast<double>(threadCounts[run]) << ","
+                 << nodeOverhead(nodes, baseNodes) << "\n";
+        }
+    }
+}
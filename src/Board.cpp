@@ -1,20 +1,119 @@
 #include "Board.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cctype>
 #include <cstddef>
 #include <cstdint>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "AttackMap.hpp"
+#include "Attacks.hpp"
 #include "Constants.hpp"
 #include "Move.hpp"
+#include "MoveList.hpp"
 
 using namespace std;
 
-Board::Board(const string& fen, std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing)
-    : allPossibleMoves(100)
-    , knightMoves(knightMoves)
-    , boardHashing(boardHashing) {
+namespace {
+
+uint16_t captureFlag(int targetSquare, uint64_t oppositeColor) {
+    return ((oppositeColor >> targetSquare) & 1) != 0 ? Move::capture : Move::quiet;
+}
+
+void addMoves(int startSquare, uint64_t targets, uint64_t oppositeColor, MoveList& moves) {
+    while (targets != 0) {
+        int targetSquare = __builtin_ctzll(targets);
+        targets &= targets - 1;
+
+        moves.emplace_back(startSquare, targetSquare, captureFlag(targetSquare, oppositeColor));
+    }
+}
+
+// Pawn moves are generated set-wise, so the start square is recovered from the step every target was reached by
+void addPawnMoves(uint64_t targets, int step, uint16_t flags, MoveList& moves) {
+    while (targets != 0) {
+        int targetSquare = __builtin_ctzll(targets);
+        targets &= targets - 1;
+
+        moves.emplace_back(targetSquare - step, targetSquare, flags);
+    }
+}
+
+// Restricts targets, which never hold our own pieces, to what the generation mode emits for the piece on square
+template <GenType Type>
+uint64_t modeTargets(uint64_t targets, int square, PieceKind kind, uint64_t oppositeColor, const CheckInfo& checks) {
+    if constexpr (Type == GenType::captures) {
+        return targets & oppositeColor;
+    } else if constexpr (Type == GenType::quiets) {
+        return targets & ~oppositeColor;
+    } else if constexpr (Type == GenType::quietChecks) {
+        uint64_t checking = checks.checkSquares[static_cast<size_t>(kind)];
+
+        if (((checks.discoverers >> square) & 1) != 0) {
+            checking |= ~lineSquares[static_cast<size_t>(checks.kingSquare)][static_cast<size_t>(square)];
+        }
+
+        return targets & ~oppositeColor & checking;
+    } else {
+        return targets;
+    }
+}
+
+// Squares a push of step from pawns would give check on, directly or by a discoverer leaving its line
+uint64_t pawnPushChecks(uint64_t pawns, int step, const CheckInfo& checks) {
+    uint64_t targets = checks.checkSquares[pawn];
+    uint64_t discoverers = pawns & checks.discoverers;
+
+    while (discoverers != 0) {
+        int square = __builtin_ctzll(discoverers);
+        discoverers &= discoverers - 1;
+
+        targets |= shiftBitboard(1ULL << square, step)
+                 & ~lineSquares[static_cast<size_t>(checks.kingSquare)][static_cast<size_t>(square)];
+    }
+
+    return targets;
+}
+
+// Pieces of either colour that are the only piece between the king and a sniper lined up with it
+uint64_t sliderBlockers(int kingSquare, uint64_t straightSnipers, uint64_t diagonalSnipers, uint64_t occupied) {
+    size_t kingIndex = static_cast<size_t>(kingSquare);
+
+    // Rays from the king stop only at snipers of the matching kind, so everything in between is a blocker
+    uint64_t snipers = (rookAttacks(kingSquare, straightSnipers) & straightSnipers)
+                     | (bishopAttacks(kingSquare, diagonalSnipers) & diagonalSnipers);
+    uint64_t blockers = 0;
+
+    while (snipers != 0) {
+        int sniper = __builtin_ctzll(snipers);
+        snipers &= snipers - 1;
+
+        uint64_t between = betweenSquares[kingIndex][static_cast<size_t>(sniper)] & occupied;
+
+        if ((between & (between - 1)) == 0) {
+            blockers |= between;
+        }
+    }
+
+    return blockers;
+}
+
+constexpr bool isSlider(int kind) {
+    return kind == bishop || kind == rook || kind == queen;
+}
+
+}   // namespace
+
+Board::Board(const string& fen) {
+    position.castleRights = allCastleRights;
+    position.enPassantSquare = noSquare;
+    position.whiteTurn = true;
+    position.pieceOn.fill(noPiece);
+
     uint64_t pos = 1;
 
     size_t endOfBoardIndex = fen.find(' ');
@@ -31,51 +130,51 @@ Board::Board(const string& fen, std::array<uint64_t, numBoardSquares>* knightMov
 
         switch (fen[i]) {
         case 'p':
-            pieceBB[blackPawn] |= pos;
+            togglePiece(blackPawn, pos);
             break;
 
         case 'P':
-            pieceBB[whitePawn] |= pos;
+            togglePiece(whitePawn, pos);
             break;
 
         case 'n':
-            pieceBB[blackKnight] |= pos;
+            togglePiece(blackKnight, pos);
             break;
 
         case 'N':
-            pieceBB[whiteKnight] |= pos;
+            togglePiece(whiteKnight, pos);
             break;
 
         case 'b':
-            pieceBB[blackBishop] |= pos;
+            togglePiece(blackBishop, pos);
             break;
 
         case 'B':
-            pieceBB[whiteBishop] |= pos;
+            togglePiece(whiteBishop, pos);
             break;
 
         case 'r':
-            pieceBB[blackRook] |= pos;
+            togglePiece(blackRook, pos);
             break;
 
         case 'R':
-            pieceBB[whiteRook] |= pos;
+            togglePiece(whiteRook, pos);
             break;
 
         case 'q':
-            pieceBB[blackQueen] |= pos;
+            togglePiece(blackQueen, pos);
             break;
 
         case 'Q':
-            pieceBB[whiteQueen] |= pos;
+            togglePiece(whiteQueen, pos);
             break;
 
         case 'k':
-            pieceBB[blackKing] |= pos;
+            togglePiece(blackKing, pos);
             break;
 
         case 'K':
-            pieceBB[whiteKing] |= pos;
+            togglePiece(whiteKing, pos);
             break;
 
         default:
@@ -84,1076 +183,1068 @@ Board::Board(const string& fen, std::array<uint64_t, numBoardSquares>* knightMov
         pos <<= 1;
     }
 
-    whitePieces = pieceBB[whitePawn] | pieceBB[whiteKnight] | pieceBB[whiteBishop] | pieceBB[whiteRook]
-                | pieceBB[whiteQueen] | pieceBB[whiteKing];
-
-    blackPieces = pieceBB[blackPawn] | pieceBB[blackKnight] | pieceBB[blackBishop] | pieceBB[blackRook]
-                | pieceBB[blackQueen] | pieceBB[blackKing];
-
     for (int pieceType = blackPawn; pieceType <= whiteKing; ++pieceType) {
-        uint64_t pieces = pieceBB[pieceType];
+        uint64_t pieces = pieceBB(pieceType);
 
         while (pieces != 0) {
             int pos = __builtin_ctzll(pieces);
-            currentEval += getValueFromPieceType(pieceType, pos);
+            position.eval += getValueFromPieceType(pieceType, pos);
+            position.pieceOn[pos] = static_cast<PieceTypes>(pieceType);
 
             pieces &= pieces - 1;
         }
     }
-};
 
-uint64_t Board::getPawnAttacks(bool white) const {
-    if (white) {
-        return (pieceBB[whitePawn] >> (boardSize - 1) & pawnAttackingRight)
-             | (pieceBB[whitePawn] >> (boardSize + 1) & pawnAttackingLeft);
-    }
+    // The remaining fields are optional, a FEN with only the board starts with white to move
+    istringstream fields(fen.substr(endOfBoardIndex));
+    string side;
+    string castling;
+    string enPassant;
 
-    return (pieceBB[blackPawn] << (boardSize - 1) & pawnAttackingLeft)
-         | (pieceBB[blackPawn] << (boardSize + 1) & pawnAttackingRight);
-}
+    int halfmoveClock = 0;
 
-void Board::getPawnMoves(bool white) {
-    uint64_t emptySquares = ~(whitePieces | blackPieces);
+    fields >> side >> castling >> enPassant >> halfmoveClock;
 
-    uint64_t pawns = white ? pieceBB[whitePawn] : pieceBB[blackPawn];
+    position.halfmoveClock = static_cast<uint8_t>(halfmoveClock);
 
-    if (pawns == 0) {
-        return;
+    position.whiteTurn = side != "b";
+
+    if (!castling.empty()) {
+        position.castleRights = 0;
+
+        for (char c : castling) {
+            switch (c) {
+            case 'K':
+                position.castleRights |= whiteKingSide;
+                break;
+            case 'Q':
+                position.castleRights |= whiteQueenSide;
+                break;
+            case 'k':
+                position.castleRights |= blackKingSide;
+                break;
+            case 'q':
+                position.castleRights |= blackQueenSide;
+                break;
+            default:
+                break;
+            }
+        }
     }
 
-    if (white) {
-        uint64_t startRow = rowMasks(boardSize - 2);
+    if (enPassant.size() == 2) {
+        position.enPassantSquare
+          = static_cast<int8_t>((boardSize - (enPassant[1] - '0')) * boardSize + (enPassant[0] - 'a'));
+    }
 
-        uint64_t singleStep = (pawns >> boardSize) & emptySquares;
-        uint64_t doubleStep = ((pawns & startRow) >> boardSize * 2) & emptySquares & (singleStep >> boardSize);
-        uint64_t attackLeft = pawns >> (boardSize + 1) & pawnAttackingLeft & blackPieces;
-        uint64_t attackRight = pawns >> (boardSize - 1) & pawnAttackingRight & blackPieces;
+    stateStack.reserve(maxSearchPly);
 
-        while (pawns != 0) {
-            int startSquare = __builtin_ctzll(pawns);
-            pawns &= pawns - 1;
+    position.hashKey = computeHash();
+    computeAttackMaps();
+    updateCheckInfo();
+};
 
-            uint64_t startSquareMask = 1ULL << startSquare;
+Board::Board(const Position& position)
+    : position(position) {
+    stateStack.reserve(maxSearchPly);
+    computeAttackMaps();
+    updateCheckInfo();
+}
 
-            // Single step forward move
-            uint64_t target = startSquareMask >> boardSize;
+void Board::setPosition(const Position& newPosition) {
+    position = newPosition;
+    stateStack.clear();
+    computeAttackMaps();
+    updateCheckInfo();
+}
 
-            if ((singleStep & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+template <Color Us>
+uint64_t Board::getPawnAttacks() const {
+    constexpr int forwardStep = Us == Color::white ? -boardSize : boardSize;
 
-            // Double step forward move
-            target = startSquareMask >> boardSize * 2;
-            if ((doubleStep & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+    uint64_t pawns = pieceBB<Us>(pawn);
 
-            // Attack left
-            target = startSquareMask >> (boardSize + 1);
-            if ((attackLeft & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+    return (shiftBitboard(pawns, forwardStep - 1) & pawnAttackingLeft)
+         | (shiftBitboard(pawns, forwardStep + 1) & pawnAttackingRight);
+}
 
-            // Attack right
-            target = startSquareMask >> (boardSize - 1);
-            if ((attackRight & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
-        }
-    } else {
-        uint64_t startRow = rowMasks(1);
+template <Color Us, GenType Type>
+void Board::getPawnMoves(MoveList& moves) {
+    constexpr int forwardStep = Us == Color::white ? -boardSize : boardSize;
+    constexpr int leftStep = forwardStep - 1;
+    constexpr int rightStep = forwardStep + 1;
+    constexpr uint64_t startRow = rowMasks(Us == Color::white ? boardSize - 2 : 1);
 
-        uint64_t singleStep = (pawns << boardSize) & emptySquares;
-        uint64_t doubleStep = ((pawns & startRow) << (boardSize * 2)) & emptySquares & (singleStep << boardSize);
-        uint64_t attackLeft = (pawns << (boardSize - 1)) & pawnAttackingLeft & whitePieces;
-        uint64_t attackRight = (pawns << (boardSize + 1)) & pawnAttackingRight & whitePieces;
+    uint64_t emptySquares = ~(whitePieces() | blackPieces());
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
+    uint64_t pawns = pieceBB<Us>(pawn);
 
-        while (pawns != 0) {
-            int startSquare = __builtin_ctzll(pawns);
-            pawns &= pawns - 1;
+    if constexpr (Type != GenType::captures) {
+        uint64_t singleStep = shiftBitboard(pawns, forwardStep) & emptySquares;
+        uint64_t doubleStep = shiftBitboard(shiftBitboard(pawns & startRow, forwardStep) & emptySquares, forwardStep)
+                            & emptySquares;
 
-            uint64_t startSquareMask = 1ULL << startSquare;
+        if constexpr (Type == GenType::quietChecks) {
+            CheckInfo checks = checkInfoFor<Us, GenType::quietChecks>();
 
-            // Single step forward move
-            uint64_t target = startSquareMask << boardSize;
-            if ((singleStep & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+            singleStep &= pawnPushChecks(pawns, forwardStep, checks);
+            doubleStep &= pawnPushChecks(pawns, 2 * forwardStep, checks);
+        }
 
-            // Double step forward move
-            target = startSquareMask << (boardSize * 2);
-            if ((doubleStep & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+        addPawnMoves(singleStep, forwardStep, Move::quiet, moves);
+        addPawnMoves(doubleStep, 2 * forwardStep, Move::doublePawnPush, moves);
+    }
 
-            // Attack left
-            target = startSquareMask << (boardSize - 1);
-            if ((attackLeft & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
+    if constexpr (Type == GenType::captures || Type == GenType::all) {
+        uint64_t attackLeft = shiftBitboard(pawns, leftStep) & pawnAttackingLeft & oppositeColor;
+        uint64_t attackRight = shiftBitboard(pawns, rightStep) & pawnAttackingRight & oppositeColor;
 
-            // Attack right
-            target = startSquareMask << (boardSize + 1);
-            if ((attackRight & target) != 0) {
-                allPossibleMoves.emplace_back(startSquareMask, target);
-            }
-        }
+        addPawnMoves(attackLeft, leftStep, Move::capture, moves);
+        addPawnMoves(attackRight, rightStep, Move::capture, moves);
     }
 }
 
-uint64_t Board::getKnightAttacks(bool white) const {
-    uint64_t knights = white ? pieceBB[whiteKnight] : pieceBB[blackKnight];
+template <Color Us>
+uint64_t Board::getKnightAttacks() const {
+    uint64_t knights = pieceBB<Us>(knight);
     uint64_t attacks = 0;
 
-    if (knights == 0) {
-        return attacks;
-    }
-
     while (knights != 0) {
         int startSquare = __builtin_ctzll(knights);
         knights &= knights - 1;
 
-        attacks |= (*knightMoves)[startSquare];
+        attacks |= knightAttacks[static_cast<size_t>(startSquare)];
     }
 
     return attacks;
 }
 
-void Board::getKnightMoves(bool white) {
-    uint64_t knights = white ? pieceBB[whiteKnight] : pieceBB[blackKnight];
-
-    if (knights == 0) {
-        return;
-    }
-
-    uint64_t possibleSpots = ~(white ? whitePieces : blackPieces);
-
+template <Color Us, GenType Type>
+void Board::getKnightMoves(MoveList& moves) {
+    uint64_t knights = pieceBB<Us>(knight);
+    uint64_t possibleSpots = ~piecesOf<Us>();
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
+    CheckInfo checks = checkInfoFor<Us, Type>();
 
     while (knights != 0) {
         int startSquare = __builtin_ctzll(knights);
         knights &= knights - 1;
 
-        uint64_t startSquareMask = 1ULL << startSquare;
-
-        int row = startSquare / boardSize;
-        int col = startSquare % boardSize;
-
-        for (int offset : knightOffsets) {
-            int targetSquare = startSquare + offset;
-
-            if (targetSquare < 0 || targetSquare >= numBoardSquares) {
-                continue;
-            }
-
-            int newRow = targetSquare / boardSize;
-            int newCol = targetSquare % boardSize;
-
-            int rowDiff = abs(newRow - row);
-            int colDiff = abs(newCol - col);
-
-            if ((rowDiff != 2 || colDiff != 1) && (rowDiff != 1 || colDiff != 2)) {
-                continue;
-            }
-
-            uint64_t targetMask = (1ULL << targetSquare);
-
-            if ((targetMask & possibleSpots) == 0) {
-                continue;
-            }
+        uint64_t targets = knightAttacks[static_cast<size_t>(startSquare)] & possibleSpots;
 
-            allPossibleMoves.emplace_back(startSquareMask, targetMask);
-        }
+        addMoves(startSquare, modeTargets<Type>(targets, startSquare, knight, oppositeColor, checks), oppositeColor,
+                 moves);
     }
 }
 
 
-uint64_t Board::getStraightAttacks(uint64_t pieces, bool white) const {
+uint64_t Board::getStraightAttacks(uint64_t pieces) const {
+    uint64_t occupied = whitePieces() | blackPieces();
     uint64_t attacks = 0;
 
-    if (pieces == 0) {
-        return attacks;
-    }
-    uint64_t sameColor = white ? whitePieces : blackPieces;
-    uint64_t oppositeColor = white ? blackPieces : whitePieces;
-
-
-    while (pieces > 0) {
+    while (pieces != 0) {
         int startingPosition = __builtin_ctzll(pieces);
         pieces &= pieces - 1;
 
-        for (int dir : straightDirections) {
-            int newPos = startingPosition;
-            while (true) {
-                newPos = newPos + dir;
-
-                if (newPos < 0 || newPos >= numBoardSquares) {
-                    break;
-                }
-
-                if (dir == -1 && (newPos % boardSize == boardSize - 1)) {
-                    break;
-                }
-                if (dir == 1 && (newPos % boardSize == 0)) {
-                    break;
-                }
-                uint64_t newPosMask = 1ULL << newPos;
-
-
-                attacks |= newPosMask;
-
-                if ((sameColor & newPosMask) != 0) {
-                    break;
-                }
-                if ((oppositeColor & newPosMask) != 0) {
-                    break;
-                }
-            }
-        }
+        attacks |= rookAttacks(startingPosition, occupied);
     }
     return attacks;
 }
 
-void Board::getStraightMoves(uint64_t pieces, bool white) {
-    if (pieces == 0) {
-        return;
-    }
-
-    uint64_t sameColor = white ? whitePieces : blackPieces;
-    uint64_t oppositeColor = white ? blackPieces : whitePieces;
-
+template <Color Us, GenType Type>
+void Board::getStraightMoves(uint64_t pieces, PieceKind kind, const CheckInfo& checks, MoveList& moves) {
+    uint64_t occupied = whitePieces() | blackPieces();
+    uint64_t possibleSpots = ~piecesOf<Us>();
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
 
     while (pieces != 0) {
         int startingPosition = __builtin_ctzll(pieces);
         pieces &= pieces - 1;
 
-        for (int dir : straightDirections) {
-            int newPos = startingPosition;
-            while (true) {
-                newPos = newPos + dir;
+        uint64_t targets = rookAttacks(startingPosition, occupied) & possibleSpots;
 
-                if (newPos < 0 || newPos >= numBoardSquares) {
-                    break;
-                }
-
-                if (newPos >= numBoardSquares) {
-                    break;
-                }
-
-                if (dir == -1 && (newPos % boardSize == boardSize - 1)) {
-                    break;
-                }
-                if (dir == 1 && (newPos % boardSize == 0)) {
-                    break;
-                }
+        addMoves(startingPosition, modeTargets<Type>(targets, startingPosition, kind, oppositeColor, checks),
+                 oppositeColor, moves);
+    }
+}
 
-                uint64_t newPosMask = 1ULL << newPos;
+template <Color Us>
+uint64_t Board::getRookAttacks() const {
+    return getStraightAttacks(pieceBB<Us>(rook));
+}
 
-                if ((sameColor & newPosMask) != 0) {
-                    break;
-                }
+template <Color Us, GenType Type>
+void Board::getRookMoves(MoveList& moves) {
+    getStraightMoves<Us, Type>(pieceBB<Us>(rook), rook, checkInfoFor<Us, Type>(), moves);
+}
 
-                uint64_t startingPositionMask = 1ULL << startingPosition;
+uint64_t Board::getDiagonalAttacks(uint64_t pieces) const {
+    uint64_t occupied = whitePieces() | blackPieces();
+    uint64_t attacks = 0;
 
-                allPossibleMoves.emplace_back(startingPositionMask, newPosMask);
+    while (pieces != 0) {
+        int startingPosition = __builtin_ctzll(pieces);
+        pieces &= pieces - 1;
 
-                if ((oppositeColor & newPosMask) != 0) {
-                    break;
-                }
-            }
-        }
+        attacks |= bishopAttacks(startingPosition, occupied);
     }
+    return attacks;
 }
 
-uint64_t Board::getRookAttacks(bool white) const {
-    uint64_t pieces = white ? pieceBB[whiteRook] : pieceBB[blackRook];
-
-    return getStraightAttacks(pieces, white);
+template <Color Us>
+uint64_t Board::getBishopAttacks() const {
+    return getDiagonalAttacks(pieceBB<Us>(bishop));
 }
 
-void Board::getRookMoves(bool white) {
-    uint64_t pieces = white ? pieceBB[whiteRook] : pieceBB[blackRook];
+template <Color Us>
+uint64_t Board::getQueenAttacks() const {
+    uint64_t queens = pieceBB<Us>(queen);
 
-    getStraightMoves(pieces, white);
+    return getStraightAttacks(queens) | getDiagonalAttacks(queens);
 }
 
-uint64_t Board::getDiagonalAttacks(uint64_t pieces, bool white) const {
-    uint64_t sameColor = white ? whitePieces : blackPieces;
-    uint64_t oppositeColor = white ? blackPieces : whitePieces;
 
-    uint64_t attacks = 0;
+template <Color Us, GenType Type>
+void Board::getDiagonalMoves(uint64_t pieces, PieceKind kind, const CheckInfo& checks, MoveList& moves) {
+    uint64_t occupied = whitePieces() | blackPieces();
+    uint64_t possibleSpots = ~piecesOf<Us>();
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
 
     while (pieces != 0) {
         int startingPosition = __builtin_ctzll(pieces);
         pieces &= pieces - 1;
 
-        for (int dir : diagonalDirections) {
-            int newPos = startingPosition;
-            while (true) {
-                newPos = newPos + dir;
+        uint64_t targets = bishopAttacks(startingPosition, occupied) & possibleSpots;
 
-                if (newPos < 0 || newPos >= numBoardSquares) {
-                    break;
-                }
+        addMoves(startingPosition, modeTargets<Type>(targets, startingPosition, kind, oppositeColor, checks),
+                 oppositeColor, moves);
+    }
+}
 
-                if (dir == boardSize + 1 && newPos % boardSize == 0) {
-                    break;
-                }
-                if (dir == boardSize - 1 && newPos % boardSize == boardSize - 1) {
-                    break;
-                }
-                if (dir == -boardSize + 1 && newPos % boardSize == 0) {
-                    break;
-                }
-                if (dir == -boardSize - 1 && newPos % boardSize == boardSize - 1) {
-                    break;
-                }
+template <Color Us, GenType Type>
+void Board::getBishopMoves(MoveList& moves) {
+    getDiagonalMoves<Us, Type>(pieceBB<Us>(bishop), bishop, checkInfoFor<Us, Type>(), moves);
+}
 
+template <Color Us, GenType Type>
+void Board::getQueenMoves(MoveList& moves) {
+    CheckInfo checks = checkInfoFor<Us, Type>();
 
-                uint64_t newPosMask = 1ULL << newPos;
+    getStraightMoves<Us, Type>(pieceBB<Us>(queen), queen, checks, moves);
+    getDiagonalMoves<Us, Type>(pieceBB<Us>(queen), queen, checks, moves);
+}
 
-                attacks |= newPosMask;
+template <Color Us>
+uint64_t Board::getKingAttacks() const {
+    uint64_t kingMask = pieceBB<Us>(king);
 
-                if ((sameColor & newPosMask) != 0) {
-                    break;
-                }
-                if ((oppositeColor & newPosMask) != 0) {
-                    break;
-                }
-            }
-        }
-        ++startingPosition;
+    if (kingMask == 0) {
+        return 0;
     }
-    return attacks;
-}
 
-uint64_t Board::getBishopAttacks(bool white) const {
-    uint64_t pieces = white ? pieceBB[whiteBishop] : pieceBB[blackBishop];
-
-    return getDiagonalAttacks(pieces, white);
+    return kingAttacks[static_cast<size_t>(__builtin_ctzll(kingMask))];
 }
-uint64_t Board::getQueenAttacks(bool white) const {
-    uint64_t pieces = white ? pieceBB[whiteQueen] : pieceBB[blackQueen];
 
-    return getDiagonalAttacks(pieces, white) | getStraightAttacks(pieces, white);
+template <Color Us>
+uint64_t Board::getAttackMap(uint64_t occupied) const {
+    AttackingPieces pieces { pieceBB<Us>(pawn),
+                             pieceBB<Us>(knight),
+                             pieceBB<Us>(bishop) | pieceBB<Us>(queen),
+                             pieceBB<Us>(rook) | pieceBB<Us>(queen),
+                             pieceBB<Us>(king),
+                             Us == Color::white };
+
+    return attackMap(pieces, occupied);
 }
 
+template <Color Us>
+uint64_t Board::computeSlidingAttacks() const {
+    uint64_t queens = pieceBB<Us>(queen);
 
-void Board::getDiagonalMoves(uint64_t pieces, bool white) {
-    uint64_t sameColor = white ? whitePieces : blackPieces;
-    uint64_t oppositeColor = white ? blackPieces : whitePieces;
+    return getStraightAttacks(pieceBB<Us>(rook) | queens) | getDiagonalAttacks(pieceBB<Us>(bishop) | queens);
+}
 
-    while (pieces != 0) {
-        int startingPosition = __builtin_ctzll(pieces);
-        pieces &= pieces - 1;
+template <Color Us>
+uint64_t Board::computeNonSlidingAttacks() const {
+    return getPawnAttacks<Us>() | getKnightAttacks<Us>() | getKingAttacks<Us>();
+}
 
+void Board::computeAttackMaps() {
+    whiteSlidingAttacking = computeSlidingAttacks<Color::white>();
+    whiteNonSlidingAttacking = computeNonSlidingAttacks<Color::white>();
+    blackNonSlidingAttacking = computeNonSlidingAttacks<Color::black>();
+    blackSlidingAttacking = computeSlidingAttacks<Color::black>();
+}
 
-        for (int dir : diagonalDirections) {
-            int newPos = startingPosition;
-            while (true) {
-                newPos += dir;
+template <Color Us>
+void Board::updateAttackMaps(PieceTypes pieceType, PieceTypes capturedPiece, uint64_t changedSquares) {
+    uint64_t& sliding = Us == Color::white ? whiteSlidingAttacking : blackSlidingAttacking;
+    uint64_t& nonSliding = Us == Color::white ? whiteNonSlidingAttacking : blackNonSlidingAttacking;
 
-                if (newPos < 0 || newPos >= numBoardSquares) {
-                    break;
-                }
-                if (dir == boardSize + 1 && newPos % boardSize == 0) {
-                    break;
-                }
-                if (dir == boardSize - 1 && newPos % boardSize == boardSize - 1) {
-                    break;
-                }
-                if (dir == -(boardSize - 1) && newPos % boardSize == 0) {
-                    break;
-                }
-                if (dir == -(boardSize + 1) && newPos % boardSize == boardSize - 1) {
-                    break;
-                }
+    // A slider's rays only change when an occupancy change lies on them, the other pieces only attack from where
+    // they stand
+    bool slidersChanged = (sliding & changedSquares) != 0;
+    bool stepsChanged = false;
 
-                uint64_t newPosMask = 1ULL << newPos;
+    for (PieceTypes piece : { pieceType, capturedPiece }) {
+        if (piece != noPiece && pieceColor(piece) == static_cast<int>(Us)) {
+            (isSlider(pieceKind(piece)) ? slidersChanged : stepsChanged) = true;
+        }
+    }
 
-                if ((sameColor & newPosMask) != 0) {
-                    break;
-                }
+    if (slidersChanged) {
+        sliding = computeSlidingAttacks<Us>();
+    }
 
-                uint64_t startingPositionMask = 1ULL << startingPosition;
+    if (stepsChanged) {
+        nonSliding = computeNonSlidingAttacks<Us>();
+    }
+}
 
-                allPossibleMoves.emplace_back(startingPositionMask, newPosMask);
+template <Color Us, GenType Type>
+void Board::getKingMoves(MoveList& moves) {
+    uint64_t kingMask = pieceBB<Us>(king);
 
-                // Check for opposite-color pieces
-                if ((oppositeColor & newPosMask) != 0) {
-                    break;
-                }
-            }
-        }
+    if (kingMask == 0) {
+        return;
     }
-}
 
-void Board::getBishopMoves(bool white) {
-    uint64_t pieces = white ? pieceBB[whiteBishop] : pieceBB[blackBishop];
+    int startSquare = __builtin_ctzll(kingMask);
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
+    uint64_t targets = kingAttacks[static_cast<size_t>(startSquare)] & ~piecesOf<Us>();
 
-    getDiagonalMoves(pieces, white);
+    addMoves(startSquare, modeTargets<Type>(targets, startSquare, king, oppositeColor, checkInfoFor<Us, Type>()),
+             oppositeColor, moves);
 }
 
-void Board::getQueenMoves(bool white) {
-    uint64_t pieces = white ? pieceBB[whiteQueen] : pieceBB[blackQueen];
-    getStraightMoves(pieces, white);
-    getDiagonalMoves(pieces, white);
-}
+template <Color Us>
+CheckInfo Board::computeCheckInfo() const {
+    constexpr Color Them = opposite(Us);
 
-uint64_t Board::getKingAttacks(bool white) const {
-    uint64_t attacks = 0;
+    uint64_t ourKing = pieceBB<Us>(king);
+    uint64_t theirKing = pieceBB<Them>(king);
 
-    uint64_t pieces = white ? pieceBB[whiteKing] : pieceBB[blackKing];
+    CheckInfo info {};
 
-    if (pieces == 0) {
-        return attacks;
+    if (ourKing == 0 || theirKing == 0) {
+        return info;
     }
 
+    int ourKingSquare = __builtin_ctzll(ourKing);
+    int kingSquare = __builtin_ctzll(theirKing);
+    size_t kingIndex = static_cast<size_t>(kingSquare);
+    uint64_t occupied = whitePieces() | blackPieces();
 
-    int startSquare = __builtin_ctzll(pieces);
+    info.checkers = attackersTo(ourKingSquare, occupied) & piecesOf<Them>();
 
-    int row = startSquare / boardSize;
-    int col = startSquare % boardSize;
+    info.pinned[static_cast<size_t>(Us)]
+      = sliderBlockers(ourKingSquare, pieceBB<Them>(rook) | pieceBB<Them>(queen),
+                       pieceBB<Them>(bishop) | pieceBB<Them>(queen), occupied)
+      & piecesOf<Us>();
 
-    for (int dir : kingDirections) {
-        int newPos = startSquare + dir;
+    uint64_t theirKingBlockers = sliderBlockers(kingSquare, pieceBB<Us>(rook) | pieceBB<Us>(queen),
+                                                pieceBB<Us>(bishop) | pieceBB<Us>(queen), occupied);
 
-        if (newPos < 0 || newPos >= numBoardSquares) {
-            continue;
-        }
-        int rowDiff = abs(row - (newPos / boardSize));
-        int colDiff = abs(col - (newPos % boardSize));
+    info.pinned[static_cast<size_t>(Them)] = theirKingBlockers & piecesOf<Them>();
+    info.discoverers = theirKingBlockers & piecesOf<Us>();
 
-        if (rowDiff > 1 || colDiff > 1) {
-            continue;
-        }
+    info.kingSquare = kingSquare;
 
-        attacks |= 1ULL << newPos;
-    }
+    // A pawn of ours checks from the squares a pawn of theirs on the king square would attack
+    info.checkSquares[pawn] = pawnAttacks[static_cast<size_t>(Them)][kingIndex];
+    info.checkSquares[knight] = knightAttacks[kingIndex];
+    info.checkSquares[bishop] = bishopAttacks(kingSquare, occupied);
+    info.checkSquares[rook] = rookAttacks(kingSquare, occupied);
+    info.checkSquares[queen] = info.checkSquares[bishop] | info.checkSquares[rook];
 
-    return attacks;
+    return info;
 }
 
-void Board::getKingMoves(bool white) {
-    uint64_t possibleSpots = ~(white ? whitePieces : blackPieces);
-
-    uint64_t pieces = white ? pieceBB[whiteKing] : pieceBB[blackKing];
-
-    if (pieces == 0) {
-        return;
+template <Color Us, GenType Type>
+CheckInfo Board::checkInfoFor() const {
+    if constexpr (Type == GenType::quietChecks) {
+        return (Us == Color::white) == position.whiteTurn ? checkInfo : computeCheckInfo<Us>();
+    } else {
+        return {};
     }
+}
 
-    int startSquare = __builtin_ctzll(pieces);
+void Board::updateCheckInfo() {
+    checkInfo = position.whiteTurn ? computeCheckInfo<Color::white>() : computeCheckInfo<Color::black>();
+}
 
-    int row = startSquare / boardSize;
-    int col = startSquare % boardSize;
+bool Board::givesCheck(Move move) const {
+    int startSquare = move.startSquare();
+    PieceTypes pieceType = position.pieceOn[static_cast<size_t>(startSquare)];
 
+    if ((checkInfo.checkSquares[static_cast<size_t>(pieceKind(pieceType))] & move.endMask()) != 0) {
+        return true;
+    }
 
-    for (int dir : kingDirections) {
-        int targetSquare = startSquare + dir;
+    // A discoverer that leaves its line to the king uncovers the slider behind it
+    return (checkInfo.discoverers & move.startMask()) != 0
+        && (lineSquares[static_cast<size_t>(checkInfo.kingSquare)][static_cast<size_t>(startSquare)] & move.endMask())
+             == 0;
+}
 
-        if (targetSquare < 0 || targetSquare >= numBoardSquares) {
-            continue;
-        }
+void Board::doMove(Move move) {
+    int startSquare = move.startSquare();
+    int endSquare = move.endSquare();
 
-        int rowDiff = abs(row - (targetSquare / boardSize));
-        int colDiff = abs(col - (targetSquare % boardSize));
+    uint64_t startMask = move.startMask();
+    uint64_t endMask = move.endMask();
 
-        if (rowDiff > 1 || colDiff > 1) {
-            continue;
-        }
+    PieceTypes pieceType = position.pieceOn[startSquare];
+    PieceTypes capturedPiece = position.pieceOn[endSquare];
 
-        uint64_t targetMask = (1ULL << targetSquare);
+    stateStack.push_back({ capturedPiece,
+                           position.castleRights,
+                           position.enPassantSquare,
+                           position.halfmoveClock,
+                           position.hashKey,
+                           position.eval,
+                           checkInfo,
+                           whiteSlidingAttacking,
+                           whiteNonSlidingAttacking,
+                           blackNonSlidingAttacking,
+                           blackSlidingAttacking });
 
-        if ((targetMask & possibleSpots) == 0) {
-            continue;
-        }
+    uint64_t& hashKey = position.hashKey;
 
-        uint64_t startSquareMask = 1ULL << startSquare;
+    if (capturedPiece != noPiece) {
+        togglePiece(capturedPiece, endMask);
 
-        allPossibleMoves.emplace_back(startSquareMask, targetMask);
+        position.eval -= getValueFromPieceType(capturedPiece, endSquare);
+        hashKey ^= boardHashing.pieceRandomNumbers[capturedPiece][endSquare];
     }
-}
 
-int Board::processMoveWithReEvaulation(const Move& move) {
-    int pieceTypeRemoved = -1;
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.end) != 0) {
-            pieceBB[i] &= ~move.end;
-            pieceTypeRemoved = i;
+    togglePiece(pieceType, startMask | endMask);
 
-            currentEval -= getValueFromPieceType(i, __builtin_ctzll(move.end));
+    position.pieceOn[endSquare] = pieceType;
+    position.pieceOn[startSquare] = noPiece;
 
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.end);
-            } else {
-                whitePieces = (whitePieces & ~move.end);
-            }
-            break;
-        }
-    }
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.start) != 0) {
-            pieceBB[i] = (pieceBB[i] & ~move.start) | move.end;
+    position.eval += getValueFromPieceType(pieceType, endSquare) - getValueFromPieceType(pieceType, startSquare);
+    hashKey ^= boardHashing.pieceRandomNumbers[pieceType][startSquare]
+             ^ boardHashing.pieceRandomNumbers[pieceType][endSquare];
 
-            currentEval += getValueFromPieceType(i, __builtin_ctzll(move.end))
-                         - getValueFromPieceType(i, __builtin_ctzll(move.start));
+    hashKey ^= boardHashing.castleRandomNumbers[static_cast<size_t>(position.castleRights)];
+    position.castleRights &= static_cast<int8_t>(castleRightsMask[static_cast<size_t>(startSquare)]
+                                                 & castleRightsMask[static_cast<size_t>(endSquare)]);
+    hashKey ^= boardHashing.castleRandomNumbers[static_cast<size_t>(position.castleRights)];
 
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.start) | move.end;
-            } else {
-                whitePieces = (whitePieces & ~move.start) | move.end;
-            }
-            break;
-        }
+    if (position.enPassantSquare != noSquare) {
+        hashKey ^= boardHashing.enPassantRandomNumbers[static_cast<size_t>(position.enPassantSquare % boardSize)];
     }
 
-    whiteTurn = !whiteTurn;
-    return pieceTypeRemoved;
-}
+    position.enPassantSquare
+      = static_cast<int8_t>(move.flags() == Move::doublePawnPush ? (startSquare + endSquare) / 2 : noSquare);
 
-void Board::unProcessMoveWithReEvaulation(const Move& move, int pieceTypeRemoved) {
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.end) != 0) {
-            pieceBB[i] = (pieceBB[i] & ~move.end) | move.start;
+    if (position.enPassantSquare != noSquare) {
+        hashKey ^= boardHashing.enPassantRandomNumbers[static_cast<size_t>(position.enPassantSquare % boardSize)];
+    }
 
-            currentEval += -getValueFromPieceType(i, __builtin_ctzll(move.end))
-                         + getValueFromPieceType(i, __builtin_ctzll(move.start));
+    bool pawnMove = pieceType == whitePawn || pieceType == blackPawn;
+    position.halfmoveClock
+      = pawnMove || capturedPiece != noPiece ? 0 : static_cast<uint8_t>(position.halfmoveClock + 1);
 
+    position.whiteTurn = !position.whiteTurn;
+    hashKey ^= boardHashing.turnRandomNumber[0] ^ boardHashing.turnRandomNumber[1];
 
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.end) | move.start;
-            } else {
-                whitePieces = (whitePieces & ~move.end) | move.start;
-            }
-            break;
-        }
+    if (incrementalAttackMaps) {
+        // A capture leaves the target square occupied, so only the start square changes occupancy
+        uint64_t changedSquares = capturedPiece == noPiece ? startMask | endMask : startMask;
+
+        updateAttackMaps<Color::white>(pieceType, capturedPiece, changedSquares);
+        updateAttackMaps<Color::black>(pieceType, capturedPiece, changedSquares);
+    } else {
+        computeAttackMaps();
     }
-    if (pieceTypeRemoved != -1) {
-        pieceBB[pieceTypeRemoved] |= move.end;
 
-        currentEval += getValueFromPieceType(pieceTypeRemoved, __builtin_ctzll(move.end));
+    assert(whiteSlidingAttacking == computeSlidingAttacks<Color::white>()
+           && whiteNonSlidingAttacking == computeNonSlidingAttacks<Color::white>()
+           && blackNonSlidingAttacking == computeNonSlidingAttacks<Color::black>()
+           && blackSlidingAttacking == computeSlidingAttacks<Color::black>());
 
+    updateCheckInfo();
 
-        if (pieceTypeRemoved < whitePawn) {
-            blackPieces = (blackPieces | move.end);
-        } else {
-            whitePieces = (whitePieces | move.end);
-        }
-    }
-    whiteTurn = !whiteTurn;
+    assert(hashKey == computeHash());
 }
 
-int Board::processMove(Move move) {
-    int pieceTypeRemoved = -1;
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.end) != 0) {
-            pieceBB[i] &= ~move.end;
-            pieceTypeRemoved = i;
-
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.end);
-            } else {
-                whitePieces = (whitePieces & ~move.end);
-            }
-            break;
-        }
-    }
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.start) != 0) {
-            pieceBB[i] = (pieceBB[i] & ~move.start) | move.end;
+void Board::undoMove(Move move) {
+    const BoardState& state = stateStack.back();
 
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.start) | move.end;
-            } else {
-                whitePieces = (whitePieces & ~move.start) | move.end;
-            }
-            break;
-        }
-    }
+    int startSquare = move.startSquare();
+    int endSquare = move.endSquare();
 
-    whiteTurn = !whiteTurn;
-    return pieceTypeRemoved;
-}
+    PieceTypes pieceType = position.pieceOn[endSquare];
 
-void Board::unProcessMove(Move move, int pieceTypeRemoved) {
-    for (int i = blackPawn; i <= whiteKing; ++i) {
-        if ((pieceBB[i] & move.end) != 0) {
-            pieceBB[i] = (pieceBB[i] & ~move.end) | move.start;
+    togglePiece(pieceType, move.startMask() | move.endMask());
 
-            if (i < whitePawn) {
-                blackPieces = (blackPieces & ~move.end) | move.start;
-            } else {
-                whitePieces = (whitePieces & ~move.end) | move.start;
-            }
-            break;
-        }
-    }
-    if (pieceTypeRemoved != -1) {
-        pieceBB[pieceTypeRemoved] |= move.end;
+    position.pieceOn[startSquare] = pieceType;
+    position.pieceOn[endSquare] = state.capturedPiece;
 
-        if (pieceTypeRemoved < whitePawn) {
-            blackPieces = (blackPieces | move.end);
-        } else {
-            whitePieces = (whitePieces | move.end);
-        }
+    if (state.capturedPiece != noPiece) {
+        togglePiece(state.capturedPiece, move.endMask());
     }
-    whiteTurn = !whiteTurn;
-}
 
-bool Board::moveIsValidWithCheck(Move move, bool white) {
-    int previousValue = processMove(move);
+    position.castleRights = state.castleRights;
+    position.enPassantSquare = state.enPassantSquare;
+    position.halfmoveClock = state.halfmoveClock;
+    position.hashKey = state.hashKey;
+    position.eval = state.eval;
+    checkInfo = state.checkInfo;
+    whiteSlidingAttacking = state.whiteSlidingAttacking;
+    whiteNonSlidingAttacking = state.whiteNonSlidingAttacking;
+    blackNonSlidingAttacking = state.blackNonSlidingAttacking;
+    blackSlidingAttacking = state.blackSlidingAttacking;
 
-    uint64_t oppositeAttacks = getPawnAttacks(!white) | getKnightAttacks(!white) | getBishopAttacks(!white)
-                             | getRookAttacks(!white) | getQueenAttacks(!white) | getKingAttacks(!white);
+    position.whiteTurn = !position.whiteTurn;
 
-    bool valid = (oppositeAttacks & (white ? pieceBB[whiteKing] : pieceBB[blackKing])) == 0;
+    stateStack.pop_back();
+}
 
-    unProcessMove(move, previousValue);
+uint64_t Board::attackersTo(int square, uint64_t occupied) const {
+    size_t index = static_cast<size_t>(square);
 
-    return valid;
-}
+    uint64_t straightSliders = kindBB(rook) | kindBB(queen);
+    uint64_t diagonalSliders = kindBB(bishop) | kindBB(queen);
 
-void Board::addValidMoves(const std::vector<Move>& potentialMoves, std::vector<Move>& moves, bool white) {
-    for (const Move& move : potentialMoves) {
-        if (moveIsValidWithCheck(move, white)) {
-            moves.emplace_back(move);
-        }
-    }
+    // A pawn attacks square when a pawn of the other colour on square would attack it back
+    return (pawnAttacks[static_cast<size_t>(Color::black)][index] & pieceBB<Color::white>(pawn))
+         | (pawnAttacks[static_cast<size_t>(Color::white)][index] & pieceBB<Color::black>(pawn))
+         | (knightAttacks[index] & kindBB(knight)) | (kingAttacks[index] & kindBB(king))
+         | (bishopAttacks(square, occupied) & diagonalSliders) | (rookAttacks(square, occupied) & straightSliders);
 }
 
-void Board::getValidMovesNoCheckNoKing(bool white) {
-    vector<Move> moves;
+template <Color Us>
+bool Board::isSquareAttacked(int square, uint64_t occupied) const {
+    constexpr Color Them = opposite(Us);
+    size_t index = static_cast<size_t>(square);
 
-    getQueenMoves(white);
-    getRookMoves(white);
-    getBishopMoves(white);
-    getKnightMoves(white);
-    getPawnMoves(white);
+    // Cheapest lookups first, the slider lookups only run when nothing closer attacks
+    return (pawnAttacks[static_cast<size_t>(Them)][index] & pieceBB<Us>(pawn)) != 0
+        || (knightAttacks[index] & pieceBB<Us>(knight)) != 0 || (kingAttacks[index] & pieceBB<Us>(king)) != 0
+        || (bishopAttacks(square, occupied) & (pieceBB<Us>(bishop) | pieceBB<Us>(queen))) != 0
+        || (rookAttacks(square, occupied) & (pieceBB<Us>(rook) | pieceBB<Us>(queen))) != 0;
 }
 
-std::vector<Move> Board::getValidMovesWithCheck() {
-    allPossibleMoves.clear();
-
-    uint64_t kingMask = whiteTurn ? pieceBB[whiteKing] : pieceBB[blackKing];
-    int kingPosition = __builtin_ctzll(kingMask);
+bool Board::targetIsUncontested(Move move) const {
+    PieceTypes mover = position.pieceOn[static_cast<size_t>(move.startSquare())];
+    bool white = pieceColor(mover) == static_cast<int>(Color::white);
 
-    uint64_t sameColor = whiteTurn ? whitePieces : blackPieces;
-    uint64_t oppositeColor = whiteTurn ? blackPieces : whitePieces;
+    uint64_t theirAttacks = white ? getAttackMap<Color::black>() : getAttackMap<Color::white>();
+    uint64_t theirSliding = white ? slidingAttacks<Color::black>() : slidingAttacks<Color::white>();
 
-    uint64_t oppositeColorDiagonalPieces
-      = whiteTurn ? pieceBB[blackBishop] | pieceBB[blackQueen] : pieceBB[whiteBishop] | pieceBB[whiteQueen];
+    // An opposing slider can only join in behind the mover when its rays reach the mover's square
+    return (theirAttacks & move.endMask()) == 0 && (theirSliding & move.startMask()) == 0;
+}
 
-    uint64_t oppositeColorStraightPieces
-      = whiteTurn ? pieceBB[blackRook] | pieceBB[blackQueen] : pieceBB[whiteRook] | pieceBB[whiteQueen];
+int Board::see(Move move) const {
+    int target = move.endSquare();
+    uint64_t fromMask = move.startMask();
 
+    if (targetIsUncontested(move)) {
+        PieceTypes victim = position.pieceOn[static_cast<size_t>(target)];
+        return victim == noPiece ? 0 : pieceValues[static_cast<size_t>(pieceKind(victim))];
+    }
 
-    uint64_t slidingAttacksMask = 0;
-    uint64_t nonSlidingAttacksMask = 0;
+    uint64_t occupied = whitePieces() | blackPieces();
+    uint64_t attackers = attackersTo(target, occupied);
+    uint64_t straightSliders = kindBB(rook) | kindBB(queen);
+    uint64_t diagonalSliders = kindBB(bishop) | kindBB(queen);
 
-    if (whiteTurn) {
-        slidingAttacksMask = getBishopAttacks(false) | getRookAttacks(false) | getQueenAttacks(false);
-        nonSlidingAttacksMask = getPawnAttacks(false) | getKnightAttacks(false) | getKingAttacks(false);
-    } else {
-        slidingAttacksMask = getBishopAttacks(true) | getRookAttacks(true) | getQueenAttacks(true);
-        nonSlidingAttacksMask = getPawnAttacks(true) | getKnightAttacks(true) | getKingAttacks(true);
-    }
+    PieceTypes captured = position.pieceOn[static_cast<size_t>(target)];
+    PieceTypes mover = position.pieceOn[static_cast<size_t>(move.startSquare())];
 
-    uint64_t combinedAttacks = slidingAttacksMask | nonSlidingAttacksMask;
+    // gain[depth] is what the side making the depth-th capture has won if the exchange stops right after it
+    array<int, 32> gain {};
+    int depth = 0;
 
-    bool doubleSlidingAttack = false;
-    int slidingAttackDirection = 0;
-    int slidingAttackDirection2 = 0;
-    int slidingPieceAttackerLocation = -1;
-    int slidingPieceAttackerLocation2 = -1;
+    gain[0] = captured == noPiece ? 0 : pieceValues[static_cast<size_t>(pieceKind(captured))];
 
+    int attackerKind = pieceKind(mover);
+    size_t side = static_cast<size_t>(pieceColor(mover));
 
-    int kingRow = kingPosition / boardSize;
-    int kingCol = kingPosition % boardSize;
+    while (fromMask != 0 && depth + 1 < static_cast<int>(gain.size())) {
+        ++depth;
+        gain[static_cast<size_t>(depth)]
+          = pieceValues[static_cast<size_t>(attackerKind)] - gain[static_cast<size_t>(depth - 1)];
 
-    bool kingUnderAttackBySlidingPiece = (kingMask & slidingAttacksMask) != 0;
+        // A quiet mover never attacked the target, so the bit is cleared rather than flipped
+        occupied &= ~fromMask;
+        attackers &= ~fromMask;
 
-    uint64_t pinnedPieces = 0;
+        // Sliders lined up behind the piece that just captured
+        attackers |= ((bishopAttacks(target, occupied) & diagonalSliders)
+                      | (rookAttacks(target, occupied) & straightSliders))
+                   & occupied;
 
-    for (int dir : straightDirections) {
-        int newPos = kingPosition;
+        side ^= 1;
+        fromMask = 0;
 
-        int closestSameColorPieceLocation = -1;
+        uint64_t sideAttackers = attackers & position.colorBB[side];
 
-        while (true) {
-            int lastRow = newPos / boardSize;
-            int lastCol = newPos % boardSize;
-            newPos = newPos + dir;
+        for (int kind = pawn; kind <= king; ++kind) {
+            uint64_t candidates = sideAttackers & kindBB(static_cast<PieceKind>(kind));
 
-            if (newPos < 0 || newPos >= numBoardSquares) {
+            if (candidates != 0) {
+                fromMask = candidates & -candidates;
+                attackerKind = kind;
                 break;
             }
+        }
 
-            int rowDiff = abs(lastRow - (newPos / boardSize));
-            int colDiff = abs(lastCol - (newPos % boardSize));
+        // The king can only recapture when nothing defends the square any more
+        if (attackerKind == king && (attackers & position.colorBB[side ^ 1]) != 0) {
+            fromMask = 0;
+        }
+    }
 
-            if (rowDiff > 1 || colDiff > 1) {
-                break;
-            }
+    while (--depth > 0) {
+        gain[static_cast<size_t>(depth - 1)]
+          = -max(-gain[static_cast<size_t>(depth - 1)], gain[static_cast<size_t>(depth)]);
+    }
 
-            uint64_t newPosMask = 1ULL << newPos;
+    return gain[0];
+}
 
-            if (kingUnderAttackBySlidingPiece && closestSameColorPieceLocation == -1
-                && (oppositeColorStraightPieces & newPosMask) != 0) {
-                if (slidingPieceAttackerLocation != -1) {
-                    doubleSlidingAttack = true;
-                    slidingAttackDirection2 = dir;
-                    slidingPieceAttackerLocation2 = newPos;
-                    break;
-                }
-                slidingAttackDirection = dir;
-                slidingPieceAttackerLocation = newPos;
-                break;
-            }
+bool Board::seeGE(Move move, int threshold) const {
+    int target = move.endSquare();
+    uint64_t targetMask = move.endMask();
 
-            if ((sameColor & newPosMask) != 0) {
-                if (closestSameColorPieceLocation != -1) {
-                    break;
-                }
-                closestSameColorPieceLocation = newPos;
-            }
+    PieceTypes captured = position.pieceOn[static_cast<size_t>(target)];
+    PieceTypes mover = position.pieceOn[static_cast<size_t>(move.startSquare())];
 
-            if ((oppositeColorStraightPieces & newPosMask) != 0) {
-                pinnedPieces |= (1ULL << closestSameColorPieceLocation);
-                break;
-            }
+    // What the mover is ahead of the threshold after the capture, as seen by the side about to move
+    int swap = (captured == noPiece ? 0 : pieceValues[static_cast<size_t>(pieceKind(captured))]) - threshold;
 
-            if ((oppositeColor & newPosMask) != 0) {
-                break;
-            }
-        }
+    if (swap < 0) {
+        return false;
     }
 
-    for (int dir : diagonalDirections) {
-        int newPos = kingPosition;
+    // Still ahead even if the moved piece is lost for nothing
+    swap = pieceValues[static_cast<size_t>(pieceKind(mover))] - swap;
 
-        int closestSameColorPieceLocation = -1;
+    if (swap <= 0 || targetIsUncontested(move)) {
+        return true;
+    }
 
-        while (true) {
-            int lastRow = newPos / boardSize;
-            int lastCol = newPos % boardSize;
+    uint64_t occupied = (whitePieces() | blackPieces()) ^ move.startMask() ^ targetMask;
+    uint64_t attackers = attackersTo(target, occupied);
+    uint64_t straightSliders = kindBB(rook) | kindBB(queen);
+    uint64_t diagonalSliders = kindBB(bishop) | kindBB(queen);
 
-            newPos = newPos + dir;
+    size_t side = static_cast<size_t>(pieceColor(mover));
 
-            if (newPos < 0 || newPos >= numBoardSquares) {
-                break;
-            }
+    // Whether the exchange reaches the threshold if it stops here, flipped with every recapture
+    bool result = true;
 
-            int rowDiff = abs(lastRow - (newPos / boardSize));
-            int colDiff = abs(lastCol - (newPos % boardSize));
+    while (true) {
+        side ^= 1;
+        attackers &= occupied;
 
-            if (rowDiff > 1 || colDiff > 1) {
-                break;
-            }
+        uint64_t sideAttackers = attackers & position.colorBB[side];
 
+        if (sideAttackers == 0) {
+            break;
+        }
 
-            uint64_t newPosMask = 1ULL << newPos;
+        result = !result;
 
-            if (kingUnderAttackBySlidingPiece && closestSameColorPieceLocation == -1
-                && (oppositeColorDiagonalPieces & newPosMask) != 0) {
-                if (slidingPieceAttackerLocation != -1) {
-                    doubleSlidingAttack = true;
-                    slidingAttackDirection2 = dir;
-                    slidingPieceAttackerLocation2 = newPos;
-                    break;
-                }
-                slidingAttackDirection = dir;
-                slidingPieceAttackerLocation = newPos;
-                break;
-            }
+        int kind = pawn;
+        uint64_t candidates = 0;
 
-            if ((sameColor & newPosMask) != 0) {
-                if (closestSameColorPieceLocation != -1) {
-                    break;
-                }
-                closestSameColorPieceLocation = newPos;
-            }
+        for (; kind <= king; ++kind) {
+            candidates = sideAttackers & kindBB(static_cast<PieceKind>(kind));
 
-            if ((oppositeColorDiagonalPieces & newPosMask) != 0) {
-                pinnedPieces |= (1ULL << closestSameColorPieceLocation);
+            if (candidates != 0) {
                 break;
             }
+        }
 
-            if ((oppositeColor & newPosMask) != 0) {
-                break;
-            }
+        if (kind == king) {
+            // Capturing with the king only works when the other side has nothing left to recapture with
+            return (attackers & position.colorBB[side ^ 1]) != 0 ? !result : result;
         }
-    }
 
+        swap = pieceValues[static_cast<size_t>(kind)] - swap;
 
-    vector<Move> moves;
+        if (swap < static_cast<int>(result)) {
+            break;
+        }
 
+        occupied ^= candidates & -candidates;
 
-    if (doubleSlidingAttack || ((kingMask & slidingAttacksMask) != 0 && (kingMask & nonSlidingAttacksMask) != 0)) {
-        // currently attacked by 2 sliding pieces or a sliding piece and non sliding piece
-        // only possible move is to have the king move out of the way
+        if (kind == pawn || kind == bishop || kind == queen) {
+            attackers |= bishopAttacks(target, occupied) & diagonalSliders;
+        }
 
-        for (int dir : kingDirections) {
-            int newPos = kingPosition + dir;
+        if (kind == rook || kind == queen) {
+            attackers |= rookAttacks(target, occupied) & straightSliders;
+        }
+    }
 
-            if (newPos < 0 || newPos >= numBoardSquares) {
-                continue;
-            }
-            if (dir == slidingAttackDirection && newPos != slidingPieceAttackerLocation) {
-                continue;
-            }
-            if (slidingPieceAttackerLocation2 != -1 && dir == slidingAttackDirection2
-                && newPos != slidingPieceAttackerLocation2) {
-                continue;
-            }
-            if (dir == -slidingAttackDirection) {
-                continue;
-            }
-            if (slidingAttackDirection2 != -1 && dir == -slidingAttackDirection2) {
-                continue;
-            }
+    return result;
+}
 
-            int newRow = newPos / boardSize;
-            int newCol = newPos % boardSize;
+bool Board::isPseudoLegal(Move move) const {
+    int startSquare = move.startSquare();
+    int endSquare = move.endSquare();
+    uint64_t endMask = move.endMask();
 
-            int rowDiff = abs(newRow - kingRow);
-            int colDiff = abs(newCol - kingCol);
+    size_t us = position.whiteTurn ? 1 : 0;
+    uint64_t sameColor = position.colorBB[us];
+    uint64_t oppositeColor = position.colorBB[us ^ 1];
+    uint64_t occupied = sameColor | oppositeColor;
 
-            if (rowDiff > 1 || colDiff > 1) {
-                continue;
-            }
+    PieceTypes pieceType = position.pieceOn[static_cast<size_t>(startSquare)];
 
-            uint64_t newPosMask = 1ULL << newPos;
+    if (pieceType == noPiece || static_cast<size_t>(pieceColor(pieceType)) != us || (endMask & sameColor) != 0) {
+        return false;
+    }
 
-            if ((newPosMask & combinedAttacks) != 0) {
-                continue;
-            }
-            if ((newPosMask & sameColor) != 0) {
-                continue;
-            }
-            moves.emplace_back(kingMask, newPosMask);
-        }
+    // This engine never generates castling, en passant or promotions, which leaves three possible flags
+    uint16_t flags = move.flags();
 
-        return moves;
+    if (flags != Move::quiet && flags != Move::doublePawnPush && flags != Move::capture) {
+        return false;
     }
 
-    if (kingUnderAttackBySlidingPiece) {
-        // currently under attack by 1 sliding piece
-        // need to block, capture attacker, or move out of the way
-        // not possible for pinned pieces to stop the attack
-        // pinned pieces can not move
-        for (int dir : kingDirections) {
-            int newPos = kingPosition + dir;
+    if (move.isCapture() != ((endMask & oppositeColor) != 0)) {
+        return false;
+    }
 
-            if ((dir == slidingAttackDirection || dir == -slidingAttackDirection)
-                && newPos != slidingPieceAttackerLocation) {
-                continue;
-            }
-            if (newPos < 0 || newPos >= numBoardSquares) {
-                continue;
-            }
+    int kind = pieceKind(pieceType);
 
-            int newRow = newPos / boardSize;
-            int newCol = newPos % boardSize;
-            int rowDiff = abs(newRow - kingRow);
-            int colDiff = abs(newCol - kingCol);
+    if (kind == pawn) {
+        int forwardStep = position.whiteTurn ? -boardSize : boardSize;
+        int startRow = position.whiteTurn ? boardSize - 2 : 1;
 
-            if (rowDiff > 1 || colDiff > 1) {
-                continue;
-            }
-            uint64_t newPosMask = 1ULL << newPos;
-            if ((newPosMask & combinedAttacks) != 0) {
-                continue;
+        if (move.isCapture()) {
+            if ((pawnAttacks[us][static_cast<size_t>(startSquare)] & endMask) == 0) {
+                return false;
             }
-            if ((newPosMask & sameColor) != 0) {
-                continue;
+        } else if (flags == Move::doublePawnPush) {
+            if (startSquare / boardSize != startRow || endSquare != startSquare + 2 * forwardStep
+                || ((1ULL << (startSquare + forwardStep)) & occupied) != 0 || (endMask & occupied) != 0) {
+                return false;
             }
-            moves.emplace_back(kingMask, newPosMask);
+        } else if (endSquare != startSquare + forwardStep || (endMask & occupied) != 0) {
+            return false;
+        }
+    } else {
+        if (flags == Move::doublePawnPush) {
+            return false;
         }
 
+        uint64_t attacks = 0;
 
-        vector<uint64_t> validEndingSpots;
+        switch (kind) {
+        case knight:
+            attacks = knightAttacks[static_cast<size_t>(startSquare)];
+            break;
+        case bishop:
+            attacks = bishopAttacks(startSquare, occupied);
+            break;
+        case rook:
+            attacks = rookAttacks(startSquare, occupied);
+            break;
+        case queen:
+            attacks = queenAttacks(startSquare, occupied);
+            break;
+        default:
+            attacks = kingAttacks[static_cast<size_t>(startSquare)];
+            break;
+        }
 
-        for (int i = kingPosition; i != slidingPieceAttackerLocation; i += slidingAttackDirection) {
-            validEndingSpots.emplace_back(1ULL << i);
+        if ((attacks & endMask) == 0) {
+            return false;
         }
-        validEndingSpots.emplace_back(1ULL << slidingPieceAttackerLocation);
+    }
 
+    // In check every move other than a king move has to capture the only checker or block its ray
+    uint64_t checkers = checkInfo.checkers;
 
-        allPossibleMoves.clear();
-        getValidMovesNoCheckNoKing(whiteTurn);
+    if (checkers != 0 && kind != king) {
+        if ((checkers & (checkers - 1)) != 0) {
+            return false;
+        }
 
-        for (const Move& move : allPossibleMoves) {
-            if ((move.start & pinnedPieces) != 0) {
-                continue;
-            }
+        int kingSquare = __builtin_ctzll(position.kindBB[king] & sameColor);
+        uint64_t checkMask
+          = checkers | betweenSquares[static_cast<size_t>(kingSquare)][static_cast<size_t>(__builtin_ctzll(checkers))];
 
-            for (uint64_t validEndingSpot : validEndingSpots) {
-                if ((move.end & validEndingSpot) != 0) {
-                    moves.emplace_back(move);
-                    break;
-                }
-            }
+        if ((checkMask & endMask) == 0) {
+            return false;
         }
-        return moves;
     }
 
-    if ((kingMask & nonSlidingAttacksMask) != 0) {
-        // currently attacked by pawn or by knight
-        // can only be attacked by 1 piece
-        // need to capture attacker or move out of the way
-        // not possible for pinned pieces to stop the attack
-        // pinned pieces can not move
+    return true;
+}
+
+bool Board::isLegal(Move move) const {
+    int startSquare = move.startSquare();
+    uint64_t startMask = move.startMask();
+    uint64_t endMask = move.endMask();
 
-        allPossibleMoves.clear();
-        getKingMoves(whiteTurn);
+    size_t us = position.whiteTurn ? 1 : 0;
+    uint64_t kingMask = position.kindBB[king] & position.colorBB[us];
+    int kingSquare = __builtin_ctzll(kingMask);
 
-        for (const Move& move : allPossibleMoves) {
-            if ((move.end & combinedAttacks) == 0) {
-                // if king move ends on a non attacked square it is a valid move
-                moves.emplace_back(move);
-            }
+    if ((startMask & kingMask) != 0) {
+        // Out of check no slider ray passes through the king, so the stored map already is the king's danger
+        if (checkInfo.checkers == 0) {
+            return ((us == 1 ? getAttackMap<Color::black>() : getAttackMap<Color::white>()) & endMask) == 0;
         }
 
+        // The king is taken off the board so that it can not retreat along the ray of a slider checking it
+        uint64_t occupied = (whitePieces() | blackPieces()) ^ startMask;
 
-        uint64_t attackSquareMask = 0;
+        return (attackersTo(move.endSquare(), occupied) & position.colorBB[us ^ 1] & ~endMask) == 0;
+    }
 
-        uint64_t pawnAttacks = getPawnAttacks(!whiteTurn);
+    // A pinned piece may only move along the line through its king
+    return (checkInfo.pinned[us] & startMask) == 0
+        || (lineSquares[static_cast<size_t>(kingSquare)][static_cast<size_t>(startSquare)] & endMask) != 0;
+}
 
-        if ((pawnAttacks & kingMask) != 0) {
-            // king is being attacked by a pawn
-            uint64_t pawns = whiteTurn ? pieceBB[blackPawn] : pieceBB[whitePawn];
+bool Board::moveIsValidWithCheck(Move move, bool white) const {
+    uint64_t startMask = move.startMask();
+    uint64_t endMask = move.endMask();
 
-            if (kingCol < boardSize) {
-                // left attack is possible
-                int pawnAttackingLeft = whiteTurn ? kingPosition - boardSize + 1 : kingPosition + boardSize + 1;
+    uint64_t kingMask = white ? pieceBB<Color::white>(king) : pieceBB<Color::black>(king);
+    int kingSquare = (kingMask & startMask) != 0 ? move.endSquare() : __builtin_ctzll(kingMask);
 
-                uint64_t pawnAttackingLeftMask = 1ULL << pawnAttackingLeft;
+    // The board as it would be after the move, a captured piece no longer attacks anything
+    uint64_t occupied = ((whitePieces() | blackPieces()) & ~startMask) | endMask;
+    uint64_t attackers = attackersTo(kingSquare, occupied) & ~endMask;
 
-                if ((pawns & pawnAttackingLeftMask) != 0) {
-                    attackSquareMask = pawnAttackingLeftMask;
-                }
-            }
-            if (attackSquareMask == 0) {
-                int rightAttackPosition = whiteTurn ? kingPosition - boardSize - 1 : kingPosition + boardSize - 1;
+    return (attackers & (white ? blackPieces() : whitePieces())) == 0;
+}
 
-                attackSquareMask = 1ULL << rightAttackPosition;
-            }
-        } else {
-            uint64_t knights = whiteTurn ? pieceBB[blackKnight] : pieceBB[whiteKnight];
+template <Color Us>
+LegalMasks Board::getLegalMasks() const {
+    constexpr Color Them = opposite(Us);
 
+    uint64_t kingMask = pieceBB<Us>(king);
+    int kingPosition = __builtin_ctzll(kingMask);
+    size_t kingIndex = static_cast<size_t>(kingPosition);
 
-            for (int dir : knightOffsets) {
-                int newPos = kingPosition + dir;
+    uint64_t sameColor = piecesOf<Us>();
+    uint64_t oppositeColor = piecesOf<Them>();
+    uint64_t occupied = whitePieces() | blackPieces();
 
-                if (newPos < 0 || newPos >= numBoardSquares) {
-                    continue;
-                }
+    uint64_t oppositeDiagonalPieces = pieceBB<Them>(bishop) | pieceBB<Them>(queen);
+    uint64_t oppositeStraightPieces = pieceBB<Them>(rook) | pieceBB<Them>(queen);
 
-                int newRow = newPos / boardSize;
-                int newCol = newPos % boardSize;
+    LegalMasks masks {};
 
-                int rowDiff = abs(newRow - kingRow);
-                int colDiff = abs(newCol - kingCol);
+    masks.checkers = (Us == Color::white) == position.whiteTurn ? checkInfo.checkers
+                                                                : attackersTo(kingPosition, occupied) & oppositeColor;
 
-                if ((rowDiff != 2 || colDiff != 1) && (rowDiff != 1 || colDiff != 2)) {
-                    continue;
-                }
+    // Squares the king can not step on. The stored map stops sliding rays at the king, so the line of every
+    // checking slider is added so that the king can not retreat along it. The checker itself stays capturable
+    // unless something defends it.
+    uint64_t kingDanger = getAttackMap<Them>();
+    uint64_t sliderCheckers = masks.checkers & (oppositeDiagonalPieces | oppositeStraightPieces);
+
+    while (sliderCheckers != 0) {
+        int checker = __builtin_ctzll(sliderCheckers);
+        sliderCheckers &= sliderCheckers - 1;
 
+        kingDanger |= lineSquares[kingIndex][static_cast<size_t>(checker)] & ~(1ULL << checker);
+    }
 
-                uint64_t newPosMask = 1ULL << newPos;
+    masks.kingTargets = kingAttacks[kingIndex] & ~sameColor & ~kingDanger;
 
-                if ((knights & newPosMask) != 0) {
-                    attackSquareMask = newPosMask;
-                    break;
-                }
-            }
+    // Not in check every square is allowed, in single check a move has to capture the checker or block its ray
+    masks.checkMask = ~0ULL;
+
+    if (masks.checkers != 0) {
+        masks.checkMask
+          = masks.checkers | betweenSquares[kingIndex][static_cast<size_t>(__builtin_ctzll(masks.checkers))];
+    }
+
+    // A pinned piece may only move along its own ray, and the rays of different pins never cross outside of the
+    // king square
+    uint64_t snipers = rookAttacks(kingPosition, oppositeColor) & oppositeStraightPieces;
+    while (snipers != 0) {
+        int sniper = __builtin_ctzll(snipers);
+        snipers &= snipers - 1;
+
+        uint64_t ray = betweenSquares[kingIndex][static_cast<size_t>(sniper)];
+
+        if (__builtin_popcountll(ray & sameColor) == 1) {
+            masks.straightPinMask |= ray | (1ULL << sniper);
         }
+    }
 
-        allPossibleMoves.clear();
-        getValidMovesNoCheckNoKing(whiteTurn);
+    snipers = bishopAttacks(kingPosition, oppositeColor) & oppositeDiagonalPieces;
+    while (snipers != 0) {
+        int sniper = __builtin_ctzll(snipers);
+        snipers &= snipers - 1;
 
-        for (const Move& move : allPossibleMoves) {
-            if (move.end == attackSquareMask && (move.start & pinnedPieces) == 0) {
-                moves.emplace_back(move);
-            }
+        uint64_t ray = betweenSquares[kingIndex][static_cast<size_t>(sniper)];
+
+        if (__builtin_popcountll(ray & sameColor) == 1) {
+            masks.diagonalPinMask |= ray | (1ULL << sniper);
         }
-        return moves;
     }
-    // currently not in check
-    // only need to check if moving reveals a sliding attack
-    // mark pinned pieces and do not let pinned pieces move off attack line
 
-    allPossibleMoves.clear();
-    getValidMovesNoCheckNoKing(whiteTurn);
+    return masks;
+}
 
-    for (const Move& move : allPossibleMoves) {
-        if ((move.start & pinnedPieces) != 0) {
-            int startPos = __builtin_ctzll(move.start);
-            int endPos = __builtin_ctzll(move.end);
+template <Color Us, GenType Type>
+void Board::getLegalMoves(const LegalMasks& masks, MoveList& moves) const {
+    uint64_t sameColor = piecesOf<Us>();
+    uint64_t oppositeColor = piecesOf<opposite(Us)>();
+    uint64_t occupied = whitePieces() | blackPieces();
+    uint64_t emptySquares = ~occupied;
 
-            int startRow = startPos / boardSize;
+    // Every target set is restricted to what this stage emits before it is serialised
+    CheckInfo checks = checkInfoFor<Us, Type>();
 
-            if (startRow == kingRow) {
-                if (startRow != endPos / boardSize) {
-                    continue;
-                }
-                moves.emplace_back(move);
-                continue;
-            }
-            int startCol = startPos % boardSize;
+    int kingPosition = __builtin_ctzll(pieceBB<Us>(king));
+    uint64_t kingTargets = modeTargets<Type>(masks.kingTargets, kingPosition, king, oppositeColor, checks);
 
-            if (startCol == kingCol) {
-                if (startCol != endPos % boardSize) {
-                    continue;
-                }
-                moves.emplace_back(move);
-                continue;
-            }
+    if ((masks.checkers & (masks.checkers - 1)) != 0) {
+        // double check, only the king can move
+        addMoves(kingPosition, kingTargets, oppositeColor, moves);
+        return;
+    }
 
-            int endRow = endPos / boardSize;
-            int endCol = endPos % boardSize;
+    uint64_t straightPinMask = masks.straightPinMask;
+    uint64_t diagonalPinMask = masks.diagonalPinMask;
 
-            if (startRow < kingRow && endRow >= kingRow) {
-                continue;
-            }
-            if (startRow > kingRow && endRow <= kingRow) {
-                continue;
-            }
-            if (startCol < kingCol && endCol >= kingCol) {
-                continue;
-            }
-            if (startCol > kingCol && endCol <= kingCol) {
-                continue;
-            }
-            if (abs(endRow - kingRow) != abs(endCol - kingCol)) {
-                continue;
-            }
-            moves.emplace_back(move);
+    uint64_t pinned = (straightPinMask | diagonalPinMask) & sameColor;
+    uint64_t targetMask = ~sameColor & masks.checkMask;
+
+    // A queen pinned along a row or column keeps only its rook moves, one pinned along a diagonal its bishop moves
+    uint64_t queens = pieceBB<Us>(queen);
+    while (queens != 0) {
+        int square = __builtin_ctzll(queens);
+        queens &= queens - 1;
+
+        uint64_t squareMask = 1ULL << square;
+        uint64_t targets = 0;
 
+        if ((squareMask & straightPinMask) != 0) {
+            targets = rookAttacks(square, occupied) & straightPinMask;
+        } else if ((squareMask & diagonalPinMask) != 0) {
+            targets = bishopAttacks(square, occupied) & diagonalPinMask;
         } else {
-            moves.emplace_back(move);
+            targets = queenAttacks(square, occupied);
+        }
+
+        addMoves(square, modeTargets<Type>(targets & targetMask, square, queen, oppositeColor, checks), oppositeColor,
+                 moves);
+    }
+
+    uint64_t rooks = pieceBB<Us>(rook) & ~diagonalPinMask;
+    while (rooks != 0) {
+        int square = __builtin_ctzll(rooks);
+        rooks &= rooks - 1;
+
+        uint64_t targets = rookAttacks(square, occupied) & targetMask;
+
+        if (((1ULL << square) & straightPinMask) != 0) {
+            targets &= straightPinMask;
         }
+
+        addMoves(square, modeTargets<Type>(targets, square, rook, oppositeColor, checks), oppositeColor, moves);
     }
 
+    uint64_t bishops = pieceBB<Us>(bishop) & ~straightPinMask;
+    while (bishops != 0) {
+        int square = __builtin_ctzll(bishops);
+        bishops &= bishops - 1;
 
-    allPossibleMoves.clear();
-    getKingMoves(whiteTurn);
+        uint64_t targets = bishopAttacks(square, occupied) & targetMask;
 
-    for (const Move& move : allPossibleMoves) {
-        if ((move.end & combinedAttacks) == 0) {
-            // if king move ends on a non attacked square it is a valid move
-            moves.emplace_back(move);
+        if (((1ULL << square) & diagonalPinMask) != 0) {
+            targets &= diagonalPinMask;
         }
+
+        addMoves(square, modeTargets<Type>(targets, square, bishop, oppositeColor, checks), oppositeColor, moves);
+    }
+
+    // A pinned knight can never stay on its ray
+    uint64_t knights = pieceBB<Us>(knight) & ~pinned;
+    while (knights != 0) {
+        int square = __builtin_ctzll(knights);
+        knights &= knights - 1;
+
+        uint64_t targets = knightAttacks[static_cast<size_t>(square)] & targetMask;
+
+        addMoves(square, modeTargets<Type>(targets, square, knight, oppositeColor, checks), oppositeColor, moves);
     }
 
+    uint64_t pawns = pieceBB<Us>(pawn);
+
+    constexpr int forwardStep = Us == Color::white ? -boardSize : boardSize;
+    constexpr int leftStep = forwardStep - 1;
+    constexpr int rightStep = forwardStep + 1;
 
-    return moves;
+    if constexpr (Type == GenType::captures || Type == GenType::all) {
+        // Captures, a pawn pinned along a row or column can not capture and a diagonally pinned pawn only its pinner
+        uint64_t capturers = pawns & ~straightPinMask;
+        uint64_t freeCapturers = capturers & ~diagonalPinMask;
+        uint64_t pinnedCapturers = capturers & diagonalPinMask;
+        uint64_t captureTargets = oppositeColor & masks.checkMask;
+
+        uint64_t attackLeft = (shiftBitboard(freeCapturers, leftStep)
+                               | (shiftBitboard(pinnedCapturers, leftStep) & diagonalPinMask))
+                            & pawnAttackingLeft & captureTargets;
+        uint64_t attackRight = (shiftBitboard(freeCapturers, rightStep)
+                                | (shiftBitboard(pinnedCapturers, rightStep) & diagonalPinMask))
+                             & pawnAttackingRight & captureTargets;
+
+        addPawnMoves(attackLeft, leftStep, Move::capture, moves);
+        addPawnMoves(attackRight, rightStep, Move::capture, moves);
+    }
+
+    if constexpr (Type != GenType::captures) {
+        // Pushes, a diagonally pinned pawn can not push and a pawn pinned along its column stays on it
+        uint64_t pushers = pawns & ~diagonalPinMask;
+
+        uint64_t singleStep = (shiftBitboard(pushers & ~straightPinMask, forwardStep)
+                               | (shiftBitboard(pushers & straightPinMask, forwardStep) & straightPinMask))
+                            & emptySquares;
+        constexpr uint64_t doubleStepRow = rowMasks(Us == Color::white ? boardSize - 3 : 2);
+        uint64_t doubleStep = shiftBitboard(singleStep & doubleStepRow, forwardStep) & emptySquares & masks.checkMask;
+
+        singleStep &= masks.checkMask;
+
+        if constexpr (Type == GenType::quietChecks) {
+            singleStep &= pawnPushChecks(pushers, forwardStep, checks);
+            doubleStep &= pawnPushChecks(pushers, 2 * forwardStep, checks);
+        }
+
+        addPawnMoves(singleStep, forwardStep, Move::quiet, moves);
+        addPawnMoves(doubleStep, 2 * forwardStep, Move::doublePawnPush, moves);
+    }
+
+    addMoves(kingPosition, kingTargets, oppositeColor, moves);
+}
+
+template <Color Us>
+void Board::getValidMovesWithCheck(MoveList& moves) {
+    getLegalMoves<Us, GenType::all>(getLegalMasks<Us>(), moves);
+}
+
+void Board::getValidMovesWithCheck(MoveList& moves) {
+    if (position.whiteTurn) {
+        getValidMovesWithCheck<Color::white>(moves);
+    } else {
+        getValidMovesWithCheck<Color::black>(moves);
+    }
 }
 
 double Board::evaluation() const {
-    return currentEval;
+    return position.eval;
 }
 
+template <Color Us>
 pair<Move, bool> Board::processUserInput(const string& userInput) {
     size_t numChars = userInput.size();
 
@@ -1161,19 +1252,18 @@ pair<Move, bool> Board::processUserInput(const string& userInput) {
     int colEnd = userInput[numChars - 2] - 'a';
 
     int endPosition = rowEnd * boardSize + colEnd;
-    uint64_t endPositionMask = 1ULL << endPosition;
 
-    allPossibleMoves.clear();
+    MoveList moves;
 
     if (userInput[0] >= 'a' && userInput[0] <= 'h') {
-        getPawnMoves(whiteTurn);
+        getPawnMoves<Us>(moves);
 
         if (userInput.size() == 2) {
-            for (const Move& move : allPossibleMoves) {
-                if (move.end != endPositionMask) {
+            for (Move move : moves) {
+                if (move.endSquare() != endPosition) {
                     continue;
                 }
-                int position = __builtin_ctzll(move.start);
+                int position = move.startSquare();
 
                 if (position % boardSize != colEnd) {
                     continue;
@@ -1184,11 +1274,11 @@ pair<Move, bool> Board::processUserInput(const string& userInput) {
         } else {
             int colStart = userInput[0] - 'a';
 
-            for (const Move& move : allPossibleMoves) {
-                if (move.end != endPositionMask) {
+            for (Move move : moves) {
+                if (move.endSquare() != endPosition) {
                     continue;
                 }
-                int position = __builtin_ctzll(move.start);
+                int position = move.startSquare();
 
                 if (position % boardSize != colStart) {
                     continue;
@@ -1215,28 +1305,28 @@ pair<Move, bool> Board::processUserInput(const string& userInput) {
 
     switch (userInput[0]) {
     case 'N':
-        getKnightMoves(whiteTurn);
+        getKnightMoves<Us>(moves);
         break;
     case 'B':
-        getBishopMoves(whiteTurn);
+        getBishopMoves<Us>(moves);
         break;
     case 'R':
-        getRookMoves(whiteTurn);
+        getRookMoves<Us>(moves);
         break;
     case 'Q':
-        getQueenMoves(whiteTurn);
+        getQueenMoves<Us>(moves);
         break;
     case 'K':
-        getKingMoves(whiteTurn);
+        getKingMoves<Us>(moves);
     default:
         break;
     }
 
-    for (const Move& move : allPossibleMoves) {
-        if (move.end != endPositionMask) {
+    for (Move move : moves) {
+        if (move.endSquare() != endPosition) {
             continue;
         }
-        int position = __builtin_ctzll(move.start);
+        int position = move.startSquare();
         if (rowStart != -1 && rowStart != position / boardSize) {
             continue;
         }
@@ -1249,11 +1339,15 @@ pair<Move, bool> Board::processUserInput(const string& userInput) {
 }
 
 
+pair<Move, bool> Board::processUserInput(const string& userInput) {
+    return position.whiteTurn ? processUserInput<Color::white>(userInput) : processUserInput<Color::black>(userInput);
+}
+
 void Board::displayBoard() const {
     vector<std::vector<char>> boardCharacters(boardSize, vector<char>(boardSize, '.'));
 
     for (int i = 0; i < numTypesPieces; ++i) {
-        uint64_t pieces = pieceBB[i];
+        uint64_t pieces = pieceBB(i);
 
 
         while (pieces != 0) {
@@ -1281,10 +1375,10 @@ void Board::displayBoard() const {
 }
 
 
-uint64_t Board::hash() const {
+uint64_t Board::computeHash() const {
     uint64_t hashVal = 0;
     for (int i = 0; i <= whiteKing; ++i) {
-        uint64_t pieces = pieceBB[i];
+        uint64_t pieces = pieceBB(i);
 
         while (pieces != 0) {
             int index = __builtin_ctzll(pieces);
@@ -1295,7 +1389,96 @@ uint64_t Board::hash() const {
         }
     }
 
-    hashVal ^= whiteTurn ? boardHashing.turnRandomNumber[0] : boardHashing.turnRandomNumber[1];
+    hashVal ^= position.whiteTurn ? boardHashing.turnRandomNumber[0] : boardHashing.turnRandomNumber[1];
+    hashVal ^= boardHashing.castleRandomNumbers[static_cast<size_t>(position.castleRights)];
+
+    if (position.enPassantSquare != noSquare) {
+        hashVal ^= boardHashing.enPassantRandomNumbers[static_cast<size_t>(position.enPassantSquare % boardSize)];
+    }
 
     return hashVal;
 }
+
+template uint64_t Board::getPawnAttacks<Color::white>() const;
+template uint64_t Board::getPawnAttacks<Color::black>() const;
+template uint64_t Board::getKnightAttacks<Color::white>() const;
+template uint64_t Board::getKnightAttacks<Color::black>() const;
+template uint64_t Board::getRookAttacks<Color::white>() const;
+template uint64_t Board::getRookAttacks<Color::black>() const;
+template uint64_t Board::getBishopAttacks<Color::white>() const;
+template uint64_t Board::getBishopAttacks<Color::black>() const;
+template uint64_t Board::getQueenAttacks<Color::white>() const;
+template uint64_t Board::getQueenAttacks<Color::black>() const;
+template uint64_t Board::getKingAttacks<Color::white>() const;
+template uint64_t Board::getKingAttacks<Color::black>() const;
+template uint64_t Board::getAttackMap<Color::white>(uint64_t occupied) const;
+template uint64_t Board::getAttackMap<Color::black>(uint64_t occupied) const;
+
+template void Board::getPawnMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getPawnMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getPawnMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getPawnMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getPawnMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getPawnMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getPawnMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getPawnMoves<Color::black, GenType::all>(MoveList& moves);
+template void Board::getKnightMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getKnightMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getKnightMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getKnightMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getKnightMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getKnightMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getKnightMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getKnightMoves<Color::black, GenType::all>(MoveList& moves);
+template void Board::getBishopMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getBishopMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getBishopMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getBishopMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getBishopMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getBishopMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getBishopMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getBishopMoves<Color::black, GenType::all>(MoveList& moves);
+template void Board::getRookMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getRookMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getRookMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getRookMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getRookMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getRookMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getRookMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getRookMoves<Color::black, GenType::all>(MoveList& moves);
+template void Board::getQueenMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getQueenMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getQueenMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getQueenMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getQueenMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getQueenMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getQueenMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getQueenMoves<Color::black, GenType::all>(MoveList& moves);
+template void Board::getKingMoves<Color::white, GenType::captures>(MoveList& moves);
+template void Board::getKingMoves<Color::black, GenType::captures>(MoveList& moves);
+template void Board::getKingMoves<Color::white, GenType::quiets>(MoveList& moves);
+template void Board::getKingMoves<Color::black, GenType::quiets>(MoveList& moves);
+template void Board::getKingMoves<Color::white, GenType::quietChecks>(MoveList& moves);
+template void Board::getKingMoves<Color::black, GenType::quietChecks>(MoveList& moves);
+template void Board::getKingMoves<Color::white, GenType::all>(MoveList& moves);
+template void Board::getKingMoves<Color::black, GenType::all>(MoveList& moves);
+
+template bool Board::isSquareAttacked<Color::white>(int square, uint64_t occupied) const;
+template bool Board::isSquareAttacked<Color::black>(int square, uint64_t occupied) const;
+
+template CheckInfo Board::computeCheckInfo<Color::white>() const;
+template CheckInfo Board::computeCheckInfo<Color::black>() const;
+
+template void Board::getValidMovesWithCheck<Color::white>(MoveList& moves);
+template void Board::getValidMovesWithCheck<Color::black>(MoveList& moves);
+
+template LegalMasks Board::getLegalMasks<Color::white>() const;
+template LegalMasks Board::getLegalMasks<Color::black>() const;
+template void Board::getLegalMoves<Color::white, GenType::captures>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::black, GenType::captures>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::white, GenType::quiets>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::black, GenType::quiets>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::white, GenType::quietChecks>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::black, GenType::quietChecks>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::white, GenType::all>(const LegalMasks& masks, MoveList& moves) const;
+template void Board::getLegalMoves<Color::black, GenType::all>(const LegalMasks& masks, MoveList& moves) const;
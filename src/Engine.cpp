@@ -7,19 +7,20 @@
 #include <limits>
 #include <queue>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "Board.hpp"
 #include "Constants.hpp"
 #include "Move.hpp"
+#include "MoveList.hpp"
 
 
 using namespace std;
-Engine::Engine(std::array<uint64_t, numBoardSquares>* knightMoves, BoardHashing& boardHashing)
-    : board(defaultBoardPosition, knightMoves, boardHashing)
+Engine::Engine()
+    : board(defaultBoardPosition)
     , workers(1, Worker(board))
     , threads(1)
-    , moves(0)
     , stop(false)
     , depth(1)
     , alpha(-numeric_limits<double>::max())
@@ -43,7 +44,14 @@ Engine::Engine(int threadNum, const Board& board, int depth)
 }
 
 Engine::~Engine() {
-    stop = true;
+    {
+        std::unique_lock<std::mutex> lock(moveMutex);
+        stop = true;
+    }
+
+    // Idle workers only check stop once they are woken
+    condition.notify_all();
+
     for (std::thread& t : threads) {
         if (t.joinable()) {
             t.join();
@@ -66,6 +74,9 @@ void Engine::generateWorkers() {
 Move Engine::findBestMove() {
     auto startTime = chrono::system_clock::now();
 
+    // The workers read the queues as soon as they wake, so they are only set up under the lock
+    std::unique_lock<std::mutex> lock(moveMutex);
+
     if (board.isWhiteTurn()) {
         movesNeedingProcessing = std::priority_queue<MoveProcessing, std::vector<MoveProcessing>,
                                                      std::function<bool(const MoveProcessing&, const MoveProcessing&)>>(
@@ -74,7 +85,9 @@ Move Engine::findBestMove() {
         finalMoveResults = std::set<MoveProcessing, std::function<bool(const MoveProcessing&, const MoveProcessing&)>>(
           [this](const MoveProcessing& mp1, const MoveProcessing& mp2) { return whiteSetFunctor(mp1, mp2); });
     } else {
-        cout << "Evaluting for black" << endl;
+        if (logging) {
+            cout << "Evaluting for black" << endl;
+        }
 
         movesNeedingProcessing = std::priority_queue<MoveProcessing, std::vector<MoveProcessing>,
                                                      std::function<bool(const MoveProcessing&, const MoveProcessing&)>>(
@@ -84,21 +97,20 @@ Move Engine::findBestMove() {
           [this](const MoveProcessing& mp1, const MoveProcessing& mp2) { return blackSetFunctor(mp1, mp2); });
     }
 
-    moves = board.getValidMovesWithCheck();
+    moves.clear();
+    board.getValidMovesWithCheck(moves);
 
     totalPositionsEvaluated = moves.size();
 
-    activeThreads = min(threads.size(), moves.size());
-
-    cout << "Moves len=" << moves.size() << " Active threads=" << activeThreads << " Depth=" << depth << endl;
+    if (logging) {
+        cout << "Moves len=" << moves.size() << " Active threads=" << min(threads.size(), moves.size())
+             << " Depth=" << depth << endl;
+    }
 
     condition.notify_all();
 
-    {
-        std::unique_lock<std::mutex> lock(moveMutex);
-        doneCondition.wait(lock,
-                           [this] { return moves.empty() && activeThreads == 0 && movesNeedingProcessing.empty(); });
-    }
+    doneCondition.wait(lock, [this] { return moves.empty() && activeThreads == 0 && movesNeedingProcessing.empty(); });
+    lock.unlock();
 
     if (finalMoveResults.empty()) {
         board.setGameOver();
@@ -121,8 +133,10 @@ Move Engine::findBestMove() {
     long long milliseconds = totalMicroseconds / 1000;
     long long microseconds = totalMicroseconds % 1000000;
 
-    cout << "Evaluated " << totalPositionsEvaluated << " positions in " << seconds << " seconds and " << milliseconds
-         << " milliseconds and " << microseconds << " microseconds\n";
+    if (logging) {
+        cout << "Evaluated " << totalPositionsEvaluated << " positions in " << seconds << " seconds and "
+             << milliseconds << " milliseconds and " << microseconds << " microseconds\n";
+    }
 
 
     if (finalMoveResults.empty()) {
@@ -130,7 +144,9 @@ Move Engine::findBestMove() {
         return {};
     }
 
-    cout << "\nEvaluation: " << it->eval << "\n";
+    if (logging) {
+        cout << "\nEvaluation: " << it->eval << "\n";
+    }
 
     return it->move;
 }
@@ -142,6 +158,7 @@ void Engine::workerTask(size_t index) {
 
         Move move {};
         int currentDepth = 1;
+        pair<double, double> window;
         {
             std::unique_lock<std::mutex> lock(moveMutex);
             condition.wait(lock, [this] { return stop || !moves.empty() || !movesNeedingProcessing.empty(); });
@@ -163,19 +180,26 @@ void Engine::workerTask(size_t index) {
                 moveProcessing.move = move;
                 moveProcessing.depth = currentDepth;
             }
+
+            // Other threads narrow the window while this one searches, so it is copied under the lock
+            window = alphaBetaValues[currentDepth - 1];
+
+            ++activeThreads;
         }
 
 
-        WorkerResult workerResult = workers[index].generateBestMove(
-          currentDepth - 1, move, alphaBetaValues[currentDepth - 1].first, alphaBetaValues[currentDepth - 1].second);
+        WorkerResult workerResult
+          = workers[index].generateBestMove(currentDepth - 1, move, window.first, window.second);
 
         {
             std::unique_lock<std::mutex> lock(moveMutex);
 
-            cout << "Finisehd " << move << " with an eval=" << workerResult.eval << " at depth " << currentDepth
-                 << " with positions evaluated=" << workerResult.positionsEvaluated
-                 << " and transpositions found=" << workerResult.samePositionCount << "\n"
-                 << flush;
+            if (logging) {
+                cout << "Finisehd " << move << " with an eval=" << workerResult.eval << " at depth " << currentDepth
+                     << " with positions evaluated=" << workerResult.positionsEvaluated
+                     << " and transpositions found=" << workerResult.samePositionCount << "\n"
+                     << flush;
+            }
 
             moveProcessing.eval = workerResult.eval;
 
@@ -192,17 +216,25 @@ void Engine::workerTask(size_t index) {
 
             if (currentDepth != depth) {
                 movesNeedingProcessing.emplace(move, currentDepth + 1, workerResult.eval);
+
+                // An idle thread can take the deeper search right away
+                condition.notify_one();
             }
 
             threadTotal += workerResult.positionsEvaluated;
+            totalPositionsEvaluated += workerResult.positionsEvaluated;
 
+            --activeThreads;
+
+            // The search is only done once no thread is still working on a move that could queue a deeper one
             if ((moves.empty() && movesNeedingProcessing.empty())) {
-                cout << "Thread " << index << " ended with a total of " << threadTotal << " evaluations" << endl;
-                totalPositionsEvaluated += threadTotal;
+                if (logging) {
+                    cout << "Thread " << index << " ended with a total of " << threadTotal << " evaluations" << endl;
+                }
 
                 threadTotal = 0;
 
-                if (--activeThreads == 0) {
+                if (activeThreads == 0) {
                     doneCondition.notify_all();
                 }
             }
@@ -210,8 +242,8 @@ void Engine::workerTask(size_t index) {
     }
 }
 
-void Engine::processMove(const Move& move) {
-    board.processMoveWithReEvaulation(move);
+void Engine::processMove(Move move) {
+    board.doMove(move);
     for (Worker& worker : workers) {
         worker.setBoard(board);
     }
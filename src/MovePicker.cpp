@@ -0,0 +1,154 @@
+#include "MovePicker.hpp"
+
+#include <cstddef>
+#include <utility>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveList.hpp"
+
+using namespace std;
+
+template <Color Us>
+MovePicker<Us>::MovePicker(const Board& board, Move hashMove, const Killers& killers, bool skipLosingCaptures)
+    : board(board)
+    , masks(board.getLegalMasks<Us>())
+    , hashMove(hashMove)
+    , killers(killers)
+    , skipLosingCaptures(skipLosingCaptures) {}
+
+template <Color Us>
+void MovePicker<Us>::generateCaptures() {
+    MoveList generated;
+    board.getLegalMoves<Us, GenType::captures>(masks, generated);
+
+    const Position& position = board.getPosition();
+
+    for (Move move : generated) {
+        if (move == hashMove) {
+            continue;
+        }
+
+        int victim = pieceValues[static_cast<size_t>(pieceKind(position.pieceOn[move.endSquare()]))];
+        int attackerKind = pieceKind(position.pieceOn[move.startSquare()]);
+
+        // A capture is winning when the exchange on its square does not lose material. Winning captures are tried
+        // most valuable victim first, ties broken by taking with the least valuable attacker.
+        if (board.seeGE(move, 0)) {
+            captureScores[captures.size()] = victim * numPieceKinds - attackerKind;
+            captures.push_back(move);
+        } else {
+            losingCaptures.push_back(move);
+        }
+    }
+}
+
+template <Color Us>
+bool MovePicker<Us>::isKiller(Move move) const {
+    for (Move killer : killers) {
+        if (move == killer) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <Color Us>
+bool MovePicker<Us>::next(Move& move) {
+    switch (stage) {
+    case Stage::hashMove:
+        stage = Stage::generateCaptures;
+
+        if (hashMove != noMove && board.isPseudoLegal(hashMove) && board.isLegal(hashMove)) {
+            move = hashMove;
+            ++movesPicked;
+            return true;
+        }
+        [[fallthrough]];
+
+    case Stage::generateCaptures:
+        generateCaptures();
+        index = 0;
+        stage = Stage::winningCaptures;
+        [[fallthrough]];
+
+    case Stage::winningCaptures:
+        // Selection sort one step at a time, most nodes only look at the first few captures
+        if (index < captures.size()) {
+            size_t best = index;
+
+            for (size_t i = index + 1; i < captures.size(); ++i) {
+                if (captureScores[i] > captureScores[best]) {
+                    best = i;
+                }
+            }
+
+            swap(captures[index], captures[best]);
+            swap(captureScores[index], captureScores[best]);
+
+            move = captures[index++];
+            ++movesPicked;
+            return true;
+        }
+
+        stage = Stage::killers;
+        [[fallthrough]];
+
+    case Stage::killers:
+        // Checked on their own, so a cutoff on a killer still skips generating the quiet moves
+        while (killerIndex < numKillers) {
+            Move killer = killers[killerIndex++];
+
+            if (killer != noMove && killer != hashMove && !killer.isCapture() && board.isPseudoLegal(killer)
+                && board.isLegal(killer)) {
+                move = killer;
+                ++movesPicked;
+                return true;
+            }
+        }
+
+        stage = Stage::generateQuiets;
+        [[fallthrough]];
+
+    case Stage::generateQuiets:
+        board.getLegalMoves<Us, GenType::quiets>(masks, quiets);
+        index = 0;
+        stage = Stage::quiets;
+        [[fallthrough]];
+
+    case Stage::quiets:
+        while (index < quiets.size()) {
+            Move quiet = quiets[index++];
+
+            if (quiet != hashMove && !isKiller(quiet)) {
+                move = quiet;
+                ++movesPicked;
+                return true;
+            }
+        }
+
+        index = 0;
+        stage = Stage::losingCaptures;
+        [[fallthrough]];
+
+    case Stage::losingCaptures:
+        if (index < losingCaptures.size() && (!skipLosingCaptures || movesPicked == 0 || index != 0)) {
+            move = losingCaptures[index++];
+            ++movesPicked;
+            return true;
+        }
+
+        stage = Stage::done;
+        [[fallthrough]];
+
+    case Stage::done:
+        break;
+    }
+
+    return false;
+}
+
+template class MovePicker<Color::white>;
+template class MovePicker<Color::black>;
@@ -0,0 +1,274 @@
+#include "Perft.hpp"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveList.hpp"
+
+using namespace std;
+
+namespace {
+
+string squareName(int square) {
+    return { static_cast<char>('a' + square % boardSize), static_cast<char>('0' + boardSize - square / boardSize) };
+}
+
+uint64_t sum(const vector<uint64_t>& counts) {
+    uint64_t total = 0;
+
+    for (uint64_t count : counts) {
+        total += count;
+    }
+
+    return total;
+}
+
+}   // namespace
+
+PerftHash::PerftHash(size_t megabytes) {
+    size_t size = bit_floor(megabytes * 1024 * 1024 / sizeof(Entry));
+
+    if (size != 0) {
+        entries = make_unique<Entry[]>(size);
+        indexMask = size - 1;
+    }
+}
+
+bool PerftHash::probe(uint64_t key, int depth, uint64_t& nodes) const {
+    if (!entries) {
+        return false;
+    }
+
+    const Entry& entry = entries[key & indexMask];
+    uint64_t data = entry.data.load(memory_order_relaxed);
+
+    if ((entry.keyXorData.load(memory_order_relaxed) ^ data) != key
+        || data >> depthShift != static_cast<uint64_t>(depth)) {
+        return false;
+    }
+
+    nodes = data & ((1ULL << depthShift) - 1);
+    return true;
+}
+
+void PerftHash::store(uint64_t key, int depth, uint64_t nodes) {
+    if (!entries) {
+        return;
+    }
+
+    Entry& entry = entries[key & indexMask];
+    uint64_t data = nodes | static_cast<uint64_t>(depth) << depthShift;
+
+    entry.keyXorData.store(key ^ data, memory_order_relaxed);
+    entry.data.store(data, memory_order_relaxed);
+}
+
+void PerftHash::clear() {
+    for (uint64_t index = 0; entries && index <= indexMask; ++index) {
+        entries[index].keyXorData.store(0, memory_order_relaxed);
+        entries[index].data.store(0, memory_order_relaxed);
+    }
+}
+
+Perft::Perft(const Board& board, size_t threadNum, size_t hashMegabytes)
+    : board(board.getPosition())
+    , threadNum(max<size_t>(threadNum, 1))
+    , hash(hashMegabytes) {}
+
+template <Color Us>
+uint64_t Perft::count(Board& threadBoard, int depth) {
+    if (depth <= 0) {
+        return 1;
+    }
+
+    uint64_t key = threadBoard.hash();
+    uint64_t nodes = 0;
+
+    if (depth > 1 && hash.probe(key, depth, nodes)) {
+        return nodes;
+    }
+
+    MoveList moves;
+    threadBoard.getValidMovesWithCheck<Us>(moves);
+
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    for (Move move : moves) {
+        threadBoard.doMove(move);
+        nodes += count<opposite(Us)>(threadBoard, depth - 1);
+        threadBoard.undoMove(move);
+    }
+
+    hash.store(key, depth, nodes);
+
+    return nodes;
+}
+
+uint64_t Perft::count(Board& threadBoard, int depth) {
+    return threadBoard.isWhiteTurn() ? count<Color::white>(threadBoard, depth)
+                                     : count<Color::black>(threadBoard, depth);
+}
+
+bool Perft::nextTask(size_t index, Task& task) {
+    for (size_t offset = 0; offset < queues.size(); ++offset) {
+        size_t victim = (index + offset) % queues.size();
+
+        lock_guard<mutex> lock(queueMutexes[victim]);
+        deque<Task>& queue = queues[victim];
+
+        if (queue.empty()) {
+            continue;
+        }
+
+        // Stealing from the other end keeps the thief away from the subtrees the owner is about to take
+        if (offset == 0) {
+            task = queue.back();
+            queue.pop_back();
+        } else {
+            task = queue.front();
+            queue.pop_front();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void Perft::workerTask(size_t index, vector<atomic<uint64_t>>& rootNodes) {
+    Board threadBoard(board.getPosition());
+    Task task {};
+
+    while (nextTask(index, task)) {
+        threadBoard.setPosition(task.position);
+        rootNodes[task.rootIndex].fetch_add(count(threadBoard, task.depth), memory_order_relaxed);
+    }
+}
+
+vector<uint64_t> Perft::run(const MoveList& rootMoves, int depth, size_t threads) {
+    queues.assign(threads, {});
+    queueMutexes = vector<mutex>(threads);
+
+    // Splitting below the replies gives enough subtrees to keep every thread busy until the end
+    size_t nextQueue = 0;
+
+    for (size_t rootIndex = 0; rootIndex < rootMoves.size(); ++rootIndex) {
+        board.doMove(rootMoves[rootIndex]);
+
+        if (depth <= 2) {
+            queues[nextQueue++ % threads].push_back({ board.getPosition(), depth - 1, rootIndex });
+        } else {
+            MoveList replies;
+            board.getValidMovesWithCheck(replies);
+
+            for (Move reply : replies) {
+                board.doMove(reply);
+                queues[nextQueue++ % threads].push_back({ board.getPosition(), depth - 2, rootIndex });
+                board.undoMove(reply);
+            }
+        }
+
+        board.undoMove(rootMoves[rootIndex]);
+    }
+
+    vector<atomic<uint64_t>> rootNodes(rootMoves.size());
+    vector<thread> workers;
+
+    for (size_t index = 0; index < threads; ++index) {
+        workers.emplace_back(&Perft::workerTask, this, index, ref(rootNodes));
+    }
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    vector<uint64_t> counts;
+
+    for (const atomic<uint64_t>& nodes : rootNodes) {
+        counts.push_back(nodes.load());
+    }
+
+    return counts;
+}
+
+uint64_t Perft::count(int depth) {
+    if (depth <= 0) {
+        return 1;
+    }
+
+    MoveList rootMoves;
+    board.getValidMovesWithCheck(rootMoves);
+
+    return sum(run(rootMoves, depth, threadNum));
+}
+
+uint64_t Perft::divide(int depth) {
+    auto startTime = chrono::steady_clock::now();
+
+    MoveList rootMoves;
+    board.getValidMovesWithCheck(rootMoves);
+
+    vector<uint64_t> counts = run(rootMoves, depth, threadNum);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    for (size_t rootIndex = 0; rootIndex < rootMoves.size(); ++rootIndex) {
+        Move move = rootMoves[rootIndex];
+        cout << squareName(move.startSquare()) << squareName(move.endSquare()) << ": " << counts[rootIndex] << "\n";
+    }
+
+    uint64_t nodes = sum(counts);
+
+    cout << "\nNodes: " << nodes << "\n";
+    cout << "Threads: " << threadNum << "\n";
+    cout << "Time: " << seconds << " seconds\n";
+    cout << "NPS: " << static_cast<uint64_t>(static_cast<double>(nodes) / seconds) << "\n";
+
+    return nodes;
+}
+
+void Perft::scaling(int depth) {
+    MoveList rootMoves;
+    board.getValidMovesWithCheck(rootMoves);
+
+    cout << setw(8) << "Threads" << setw(16) << "Nodes" << setw(12) << "Seconds" << setw(16) << "NPS" << setw(10)
+         << "Speedup" << "\n";
+
+    double oneThreadSeconds = 0.0;
+
+    for (size_t threads = 1;; threads = min(threads * 2, threadNum)) {
+        hash.clear();
+
+        auto startTime = chrono::steady_clock::now();
+        uint64_t nodes = sum(run(rootMoves, depth, threads));
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        if (threads == 1) {
+            oneThreadSeconds = seconds;
+        }
+
+        cout << fixed << setprecision(3) << setw(8) << threads << setw(16) << nodes << setw(12) << seconds << setw(16)
+             << static_cast<uint64_t>(static_cast<double>(nodes) / seconds) << setw(10) << setprecision(2)
+             << oneThreadSeconds / seconds << "\n";
+
+        if (threads >= threadNum) {
+            break;
+        }
+    }
+}
@@ -6,131 +6,141 @@
 
 #include "Constants.hpp"
 #include "Move.hpp"
+#include "MovePicker.hpp"
 
 
 using namespace std;
 
 
-WorkerResult Worker::generateBestMove(int depth, const Move& move, double alpha, double beta) {
-    resetData();
+namespace {
 
-    int startEndPieces = board.processMoveWithReEvaulation(move);
+// Worst possible score for the side to move, reached when it has no moves left
+template <Color Us>
+constexpr double worstScore() {
+    return Us == Color::white ? -numeric_limits<double>::max() : numeric_limits<double>::max();
+}
 
-    vector<Move> moves = board.getValidMovesWithCheck();
+// White maximises and black minimises, so a cutoff and a window update only differ in direction
+template <Color Us>
+constexpr bool isBetter(double eval, double value) {
+    return Us == Color::white ? eval > value : eval < value;
+}
 
+}
 
-    if (moves.size() == 0) {
-        double eval = board.isWhiteTurn() ? -numeric_limits<double>::max() : numeric_limits<double>::max();
-        board.unProcessMove(move, startEndPieces);
 
-        if (board.isWhiteTurn() && eval < beta) {
-            alpha = max(alpha, eval);
-        } else if (!board.isWhiteTurn() && eval > alpha) {
-            beta = min(beta, eval);
-        }
+WorkerResult Worker::generateBestMove(int depth, Move move, double alpha, double beta) {
+    return board.isWhiteTurn() ? generateBestMove<Color::white>(depth, move, alpha, beta)
+                               : generateBestMove<Color::black>(depth, move, alpha, beta);
+}
 
-        return { eval, alpha, beta, 1, 0 };
-    }
+template <Color Us>
+WorkerResult Worker::generateBestMove(int depth, Move move, double alpha, double beta) {
+    constexpr Color Them = opposite(Us);
 
+    resetData();
 
-    double value = 0;
+    board.doMove(move);
 
-    if (board.isWhiteTurn()) {
-        value = -numeric_limits<double>::max();
+    uint64_t hash = board.hash();
+    MovePicker<Them> picker(board, hashMove(hash), killers[1]);
 
-        for (const Move& newMove : moves) {
-            double eval = alphaBetaPruning(newMove, depth - 1, alpha, beta);
+    double value = searchMoves<Them>(picker, depth, 1, alpha, beta);
 
-            value = max(value, eval);
+    if (picker.picked() == 0) {
+        double eval = worstScore<Them>();
+        board.undoMove(move);
 
-            if (value >= beta) {
-                break;
+        if constexpr (Us == Color::white) {
+            if (eval < beta) {
+                alpha = max(alpha, eval);
             }
-
-            alpha = max(alpha, value);
-        }
-    } else {
-        value = numeric_limits<double>::max();
-
-        for (const Move& newMove : moves) {
-            double eval = alphaBetaPruning(newMove, depth - 1, alpha, beta);
-
-            value = min(value, eval);
-            if (value <= alpha) {
-                break;
+        } else {
+            if (eval > alpha) {
+                beta = min(beta, eval);
             }
-
-            beta = min(beta, value);
         }
+
+        return { eval, alpha, beta, 1, 0 };
     }
 
-    board.unProcessMoveWithReEvaulation(move, startEndPieces);
-    return { value, alpha, beta, moves.size() + totalEvaluations, totalSamePositionsFound };
+    board.undoMove(move);
+    return { value, alpha, beta, picker.picked() + totalEvaluations, totalSamePositionsFound };
 }
 
-double Worker::alphaBetaPruning(const Move& move, int depth, double alpha, double beta) {
-    int previousValue = board.processMoveWithReEvaulation(move);
+template <Color Us>
+double Worker::alphaBetaPruning(Move move, int depth, size_t ply, double alpha, double beta) {
+    constexpr Color Them = opposite(Us);
+
+    board.doMove(move);
 
     uint64_t hash = board.hash();
 
     if (boardHashes.find(hash) != boardHashes.end()) {
         ++totalSamePositionsFound;
 
-        board.unProcessMoveWithReEvaulation(move, previousValue);
+        board.undoMove(move);
         return boardHashes[hash];
     }
 
 
-    if (depth <= 0 && previousValue == -1) {
+    if (depth <= 0 && board.lastCapturedPiece() == noPiece) {
         double eval = board.evaluation();
 
 
         boardHashes[hash] = eval;
 
-        board.unProcessMoveWithReEvaulation(move, previousValue);
+        board.undoMove(move);
 
         ++totalEvaluations;
 
         return eval;
     }
 
-    double value = 0;
+    // Past the horizon the search only goes on because the last move captured, so exchanges that lose material
+    // are not followed
+    MovePicker<Them> picker(board, hashMove(hash), killers[min(ply, maxSearchPly - 1)], depth <= 0);
 
-    vector<Move> moves = board.getValidMovesWithCheck();
+    double value = searchMoves<Them>(picker, depth, ply, alpha, beta);
 
-    if (moves.empty()) {
-        double eval = board.isWhiteTurn() ? -numeric_limits<double>::max() : numeric_limits<double>::max();
-        board.unProcessMoveWithReEvaulation(move, previousValue);
+    if (picker.picked() == 0) {
+        board.undoMove(move);
 
         ++totalEvaluations;
 
-        return eval;
+        return value;
     }
 
+    boardHashes[hash] = value;
 
-    if (board.isWhiteTurn()) {
-        value = -numeric_limits<double>::max();
+    board.undoMove(move);
+    return value;
+}
 
-        for (const Move& newMove : moves) {
-            double eval = alphaBetaPruning(newMove, depth - 1, alpha, beta);
+template <Color Us>
+double Worker::searchMoves(MovePicker<Us>& picker, int depth, size_t ply, double& alpha, double& beta) {
+    double value = worstScore<Us>();
+    Move bestMove = noMove;
 
-            value = max(value, eval);
+    Move newMove {};
+    while (picker.next(newMove)) {
+        double eval = alphaBetaPruning<Us>(newMove, depth - 1, ply + 1, alpha, beta);
 
+        if (bestMove == noMove || isBetter<Us>(eval, value)) {
+            value = eval;
+            bestMove = newMove;
+        }
+
+        if constexpr (Us == Color::white) {
             if (value >= beta) {
+                storeKiller(ply, bestMove);
                 break;
             }
 
             alpha = max(alpha, value);
-        }
-    } else {
-        value = numeric_limits<double>::max();
-
-        for (const Move& newMove : moves) {
-            double eval = alphaBetaPruning(newMove, depth - 1, alpha, beta);
-
-            value = min(value, eval);
-
+        } else {
             if (value <= alpha) {
+                storeKiller(ply, bestMove);
                 break;
             }
 
@@ -138,16 +148,40 @@ double Worker::alphaBetaPruning(const Move& move, int depth, double alpha, doubl
         }
     }
 
-    boardHashes[hash] = value;
+    if (bestMove != noMove) {
+        hashMoves[board.hash()] = bestMove;
+    }
 
-    board.unProcessMoveWithReEvaulation(move, previousValue);
     return value;
 }
 
-void Worker::processMove(const Move& move) {
-    board.processMoveWithReEvaulation(move);
+Move Worker::hashMove(uint64_t hash) const {
+    auto it = hashMoves.find(hash);
+    return it == hashMoves.end() ? noMove : it->second;
+}
+
+void Worker::storeKiller(size_t ply, Move move) {
+    // Captures are already tried before the killers
+    if (move.isCapture() || ply >= maxSearchPly) {
+        return;
+    }
+
+    Killers& plyKillers = killers[ply];
+
+    if (plyKillers[0] != move) {
+        plyKillers[1] = plyKillers[0];
+        plyKillers[0] = move;
+    }
+}
+
+void Worker::processMove(Move move) {
+    board.doMove(move);
 }
 
 void Worker::setBoard(const Board& newBoard) {
-    board = newBoard;
+    board.setPosition(newBoard.getPosition());
+
+    // Hash moves and killers only help while searching the same position
+    hashMoves.clear();
+    killers = {};
 }
@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -7,10 +8,13 @@
 #include <bits/getopt_core.h>
 #include <bits/getopt_ext.h>
 
+#include "Attacks.hpp"
+#include "Bench.hpp"
 #include "Board.hpp"
 #include "Constants.hpp"
 #include "Game.hpp"
 #include "Move.hpp"
+#include "Perft.hpp"
 
 using namespace std;
 
@@ -18,6 +22,17 @@ struct Options {
     string startBoard = defaultBoardPosition;
     int threadNum = 8;
     int depth = 6;
+    SliderBackend sliderBackend = SliderBackend::automatic;
+
+    // Counts the legal move tree of the start board to this depth instead of playing, 0 plays a game
+    int perftDepth = 0;
+    size_t perftHashMegabytes = 64;
+
+    // Searches the bench positions to this depth instead of playing, 0 plays a game
+    int benchDepth = 0;
+
+    // Repeats the run with 1, 2, 4 ... threadNum threads and reports the speedup of each
+    bool scaling = false;
 };
 
 void printHelp(char* argv[]) {
@@ -32,9 +47,15 @@ void getMode(int argc, char* argv[], Options& options) {
         {   "help",       no_argument, nullptr, 'h' },
         { "thread", required_argument, nullptr, 't' },
         {  "depth", required_argument, nullptr, 'd' },
-        {  "start", required_argument, nullptr, 's' }
+        {  "start", required_argument, nullptr, 's' },
+        { "slider", required_argument, nullptr, 'l' },
+        {  "perft", required_argument, nullptr, 'p' },
+        {   "hash", required_argument, nullptr, 'H' },
+        {  "scale",       no_argument, nullptr, 'c' },
+        {  "bench", optional_argument, nullptr, 'b' },
+        {  nullptr,                 0, nullptr,   0 }
     };
-    while ((choice = getopt_long(argc, argv, "ht:d:s:", long_options, &index)) != -1) {
+    while ((choice = getopt_long(argc, argv, "ht:d:s:l:p:H:cb::", long_options, &index)) != -1) {
         switch (choice) {
         case 'h': {
             printHelp(argv);
@@ -56,63 +77,52 @@ void getMode(int argc, char* argv[], Options& options) {
             options.startBoard = arg;
             break;
         }
-        default: {
-        }
-        }
-    }
-}
-
-array<uint64_t, numBoardSquares> generateKnightMoves() {
-    std::array<uint64_t, numBoardSquares> moves {};
-    for (int i = 0; i < numBoardSquares; ++i) {
-        uint64_t move = 0;
-
-        // Check if moving left 2 is possible
-        if (i % boardSize >= 2) {
-            if (i / boardSize >= 1) {
-                move |= (1ULL << (i - boardSize - 2));   // left 2 up 1
-            }
-            if (i / boardSize <= boardSize - 2) {
-                move |= (1ULL << (i + boardSize - 2));   // left 2 down 1
+        case 'l': {
+            string arg { optarg };
+            if (arg == "auto") {
+                options.sliderBackend = SliderBackend::automatic;
+            } else if (arg == "magic") {
+                options.sliderBackend = SliderBackend::magic;
+            } else if (arg == "pext") {
+                options.sliderBackend = SliderBackend::pext;
+            } else {
+                cerr << "Unknown slider backend " << arg << ", expected auto, magic or pext\n";
+                exit(1);
             }
+            break;
         }
-
-        // Check if moving left 1 is possible
-        if (i % boardSize >= 1) {
-            if (i / boardSize >= 2) {
-                move |= (1ULL << (i - 2 * boardSize - 1));   // left 1 up 2
-            }
-            if (i / boardSize < boardSize - 2) {
-                move |= (1ULL << (i + 2 * boardSize - 1));   // left 1 down 2
+        case 'p': {
+            int arg = stoi(optarg);
+            if (arg < 1) {
+                cerr << "Perft depth has to be at least 1\n";
+                exit(1);
             }
+            options.perftDepth = arg;
+            break;
         }
-
-
-        // Check if moving right 2 is possible
-        if (i % boardSize < boardSize - 2) {
-            if (i / boardSize >= 1) {
-                move |= (1ULL << (i - boardSize + 2));   // right 2 up 1
-            }
-            if (i / boardSize <= boardSize - 2) {
-                move |= (1ULL << (i + boardSize + 2));   // right 2 down 1
-            }
+        case 'H': {
+            options.perftHashMegabytes = stoul(optarg);
+            break;
         }
-
-        // Check if moving right 1 is possible
-        if (i % boardSize < boardSize - 1) {
-            if (i / boardSize >= 2) {
-                move |= (1ULL << (i - 2 * boardSize + 1));   // right 1 up 2
-            }
-            if (i / boardSize < boardSize - 2) {
-                move |= (1ULL << (i + 2 * boardSize + 1));   // right 1 down 2
+        case 'c': {
+            options.scaling = true;
+            break;
+        }
+        case 'b': {
+            // Without a depth the signature is always taken at the same one
+            int arg = optarg != nullptr ? stoi(optarg) : 5;
+            if (arg < 1) {
+                cerr << "Bench depth has to be at least 1\n";
+                exit(1);
             }
+            options.benchDepth = arg;
+            break;
+        }
+        default: {
+        }
         }
-
-
-        moves.at(i) = move;
     }
-    return moves;
-};
+}
 
 int main(int argc, char* argv[]) {
     ios_base::sync_with_stdio(false);
@@ -122,10 +132,32 @@ int main(int argc, char* argv[]) {
     Options options;
     getMode(argc, argv, options);
 
-    auto knightMoves = generateKnightMoves();
+    initAttackTables(options.sliderBackend);
+
+    cout << "Slider attacks: " << sliderBackendName(activeSliderBackend()) << "\n";
+
+    if (options.benchDepth > 0) {
+        if (options.scaling) {
+            runBenchScaling(options.benchDepth, static_cast<size_t>(options.threadNum));
+        } else {
+            runBench(options.benchDepth);
+        }
+
+        return 0;
+    }
+
+    if (options.perftDepth > 0) {
+        Perft perft(Board(options.startBoard), static_cast<size_t>(options.threadNum), options.perftHashMegabytes);
 
-    BoardHashing boardHashing;
+        if (options.scaling) {
+            perft.scaling(options.perftDepth);
+        } else {
+            perft.divide(options.perftDepth);
+        }
+
+        return 0;
+    }
 
-    Game game(options.threadNum, options.startBoard, options.depth, &knightMoves, boardHashing);
+    Game game(options.threadNum, options.startBoard, options.depth);
     game.runGame();
 }